@@ -13,6 +13,7 @@
 
 #pragma once
 #include "MemoryInterfaces.hpp"
+#include <array>
 #include <map>
 #include <stdint.h>
 #include <string>
@@ -26,6 +27,83 @@ struct PacketData {
   uint64_t duration;
 };
 
+/* Which packets decoder reconstructs.
+ */
+enum class DecodeMode {
+  // Every frame is decoded.
+  FULL,
+
+  /* Only key frames are decoded. Other packets are dropped upon demuxing and
+   * never reach the decoder.
+   */
+  KEY_FRAMES
+};
+
+/* libswscale scaling algorithm. Only matters if source and destination
+ * sizes differ, chroma is resampled with it as well.
+ */
+enum class ScalingAlgorithm {
+  FAST_BILINEAR,
+  BILINEAR,
+  BICUBIC,
+  NEAREST,
+  AREA,
+  LANCZOS,
+  SPLINE
+};
+
+/* Wall time spent in single decoding stage.
+ */
+struct StageStats {
+  static constexpr size_t num_bins = 32U;
+
+  // Number of calls.
+  uint64_t count = 0U;
+
+  // Cumulative wall time in nanoseconds.
+  uint64_t total_ns = 0U;
+
+  /* Log2 histogram of call duration. Bin N counts calls which took
+   * [2^N, 2^(N+1)) microseconds. First bin counts all calls shorter than
+   * 2 microseconds and the last one counts all longer calls.
+   */
+  std::array<uint64_t, num_bins> histogram = {};
+
+  void Add(uint64_t ns) {
+    count++;
+    total_ns += ns;
+
+    auto us = ns / 1000U;
+    auto bin = 0U;
+    while (us > 1U && bin < num_bins - 1U) {
+      us >>= 1U;
+      bin++;
+    }
+    histogram[bin]++;
+  }
+};
+
+struct DecoderStats {
+  uint64_t num_pkt_read = 0U;
+  uint64_t num_pkt_sent = 0U;
+  uint64_t num_frm_recv = 0U;
+  uint64_t num_codec_reopen = 0U;
+
+  // Number of threads used by codec.
+  uint64_t num_threads = 0U;
+
+  /* Bytes read from input. Sum of packet sizes if it's not read through
+   * AVIOContext, e. g. by standalone decoder.
+   */
+  uint64_t bytes_read = 0U;
+
+  StageStats demux;
+  StageStats send;
+  StageStats receive;
+  StageStats copy;
+  StageStats seek;
+};
+
 struct VideoContext {
   int64_t width = 0;
   int64_t height = 0;
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace VPF {
+
+/* Instruction set used by CPU kernels. Best one supported by CPU is picked
+ * at runtime.
+ */
+enum class CpuKernelIsa { SCALAR, AVX2, AVX512, NEON };
+
+CpuKernelIsa getCpuKernelIsa();
+
+/* Coefficients of fused YUV to normalized float RGB conversion:
+ *
+ * Y' = Y * y_scale + y_offset, U' and V' are computed the same way with
+ * chroma scale and offset.
+ * R = Y' + r_v * V'
+ * G = Y' + g_u * U' + g_v * V'
+ * B = Y' + b_u * U'
+ *
+ * Result is clamped to [0; 255] and normalized per channel as
+ * x * scale[c] + offset[c].
+ */
+struct YuvToRgbCoeffs {
+  float y_scale, y_offset;
+  float c_scale, c_offset;
+  float r_v, g_u, g_v, b_u;
+  float scale[3], offset[3];
+};
+
+/* Makes coefficients for BT.601 or BT.709 matrix and given color range.
+ * Output is (RGB / 255 - mean) / std.
+ */
+YuvToRgbCoeffs makeYuvToRgbCoeffs(bool is_bt709, bool is_jpeg_range,
+                                  const std::array<float, 3>& mean,
+                                  const std::array<float, 3>& std);
+
+/* 8 bit YUV with 2x2 subsampled chroma. Chroma step is 1 for planar YUV420
+ * and 2 for NV12, in which case v points to the byte next to u.
+ */
+struct YuvPlanes {
+  const uint8_t* y;
+  const uint8_t* u;
+  const uint8_t* v;
+  int y_pitch;
+  int uv_pitch;
+  int uv_step;
+};
+
+/* Converts YUV to planar float RGB in single pass. Output planes are tightly
+ * packed one after another: R, G, B. Chroma is upsampled with nearest
+ * neighbor.
+ */
+void yuvToRgbPlanarF32(const YuvPlanes& src, float* dst, int width,
+                       int height, const YuvToRgbCoeffs& coeffs,
+                       CpuKernelIsa isa = getCpuKernelIsa());
+} // namespace VPF
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tc_export.h" // Generated by cmake
+
+#include <cstdint>
+#include <mutex>
+
+namespace VPF {
+
+/* Process-wide budget of CPU cores shared by all software decoders.
+ *
+ * Every libavcodec context spins up its own thread pool, so many decoders
+ * running in parallel oversubscribe the cores. When budget is set, decoder
+ * gets number of threads proportional to its frame size relative to frame
+ * size of all active decoders. It's capped by number of cores which aren't
+ * given to other decoders yet.
+ *
+ * libavcodec can't change number of threads of an open codec, so number of
+ * threads is assigned when codec is (re)opened and decoders which are already
+ * running keep theirs.
+ */
+class TC_EXPORT DecodeThreadBudget final {
+public:
+  DecodeThreadBudget(const DecodeThreadBudget& other) = delete;
+  DecodeThreadBudget& operator=(const DecodeThreadBudget& other) = delete;
+
+  static DecodeThreadBudget& Instance();
+
+  /* Sets number of cores shared by decoders. 0 disables the budget, it's
+   * the default.
+   */
+  void SetNumCores(uint32_t num_cores);
+  uint32_t GetNumCores() const;
+
+  /* Registers decoder with given frame size in pixels.
+   * Returns number of threads it shall use or 0 if budget is disabled.
+   * Every call must be paired with Release with the same weight and number
+   * of threads.
+   */
+  uint32_t Acquire(int64_t weight);
+  void Release(int64_t weight, uint32_t num_threads);
+
+  // Returns number of registered decoders.
+  uint32_t NumActive() const;
+
+  // libavcodec doesn't benefit from larger thread pools.
+  static constexpr uint32_t max_threads = 16U;
+
+private:
+  DecodeThreadBudget() = default;
+
+  mutable std::mutex m_mutex;
+  uint32_t m_num_cores = 0U;
+  uint32_t m_num_active = 0U;
+  uint32_t m_num_threads = 0U;
+  int64_t m_total_weight = 0;
+};
+} // namespace VPF
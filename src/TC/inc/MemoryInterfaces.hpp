@@ -17,8 +17,13 @@
 
 #include "SurfacePlane.hpp"
 #include "nvEncodeAPI.h"
+#include <memory>
 #include <vector>
 
+extern "C" {
+struct AVFrame;
+}
+
 #define ALIGN(x, a) __ALIGN_MASK(x, (decltype(x))(a)-1)
 #define __ALIGN_MASK(x, mask) (((x) + (mask)) & ~(mask))
 
@@ -259,4 +264,80 @@ private:
   uint64_t id = 0;
 #endif
 };
+
+/* Represents CPU-side video frame which shares memory with libavcodec.
+ * Holds a reference to decoded AVFrame, no memcpy is done.
+ */
+class TC_EXPORT HostFrame final : public Token {
+public:
+  HostFrame(const HostFrame& other) = delete;
+  HostFrame& operator=(const HostFrame& other) = delete;
+
+  ~HostFrame() final;
+
+  /* Returns true if frame doesn't reference any memory, false otherwise;
+   */
+  bool Empty() const;
+
+  /* Returns pixel format;
+   */
+  Pixel_Format PixelFormat() const;
+
+  /* Returns number of image planes;
+   */
+  uint32_t NumPlanes() const;
+
+  /* Returns plane width in elements;
+   */
+  uint32_t Width(uint32_t plane = 0U) const;
+
+  /* Returns plane height in pixels;
+   */
+  uint32_t Height(uint32_t plane = 0U) const;
+
+  /* Returns plane pitch in bytes;
+   */
+  uint32_t Pitch(uint32_t plane = 0U) const;
+
+  /* Returns element size in bytes;
+   */
+  uint32_t ElemSize() const;
+
+  /* Returns DLPack data type code;
+   */
+  DLDataTypeCode DataType() const;
+
+  /* Returns pointer to first element of given plane;
+   */
+  uint8_t* Data(uint32_t plane = 0U) const;
+
+  /* Returns total amount of memory in bytes needed to store all pixels
+   * without padding;
+   */
+  size_t HostMemSize() const;
+
+  /* Get DLPack descriptor of given plane. It keeps frame memory alive;
+   */
+  DLManagedTensor* ToDLPack(uint32_t plane = 0U);
+
+  /* Reference same memory as given AVFrame does;
+   */
+  void Update(const AVFrame* src);
+
+  /* Shallow copy which references same memory;
+   */
+  HostFrame* Clone() const;
+
+  /* Make empty;
+   */
+  static HostFrame* Make();
+
+private:
+  HostFrame() = default;
+
+  /* New AVFrame is allocated upon every update, so frames exported to DLPack
+   * are not affected by further updates.
+   */
+  std::shared_ptr<AVFrame> m_frame = nullptr;
+};
 } // namespace VPF
\ No newline at end of file
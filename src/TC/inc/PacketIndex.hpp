@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tc_export.h" // Generated by cmake
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VPF {
+class MappedFile;
+
+/* Single video packet description. It's stored in index file as is, so keep
+ * it POD with fixed size and alignment.
+ */
+struct PacketIndexEntry {
+  // Presentation timestamp in stream time base units.
+  int64_t pts;
+
+  // Decode timestamp in stream time base units.
+  int64_t dts;
+
+  // Byte position in the input, -1 if unknown.
+  int64_t pos;
+
+  /* Number of the closest key frame in presentation order which isn't
+   * located after this one. Decoding from it will reconstruct this frame.
+   */
+  int64_t key_num;
+
+  // Packet size in bytes.
+  int32_t size;
+
+  // Non-zero for key frames.
+  int32_t key;
+};
+
+static_assert(sizeof(PacketIndexEntry) == 40U,
+              "PacketIndexEntry layout is a part of index file format");
+
+/* Index of video stream packets in presentation order.
+ * Frame number is the position of the entry in the index.
+ *
+ * It can be saved to compact binary sidecar file. Saved index is memory
+ * mapped upon load, so it isn't parsed and doesn't take RAM until used.
+ */
+class TC_EXPORT PacketIndex final {
+public:
+  PacketIndex(const PacketIndex& other) = delete;
+  PacketIndex& operator=(const PacketIndex& other) = delete;
+  ~PacketIndex();
+
+  /* Make index from packets given in arbitrary order.
+   * key_num field of entries is calculated here.
+   */
+  static PacketIndex* Make(std::vector<PacketIndexEntry>&& entries,
+                           int stream_idx, int tb_num, int tb_den);
+
+  /* Map index file to memory;
+   * Throws std::runtime_error in case of failure.
+   */
+  static PacketIndex* Load(const std::string& path);
+
+  /* Save index to file;
+   * Throws std::runtime_error in case of failure.
+   */
+  void Save(const std::string& path) const;
+
+  /* Returns number of frames;
+   */
+  size_t Size() const { return m_size; }
+
+  /* Returns entry for given frame number;
+   */
+  const PacketIndexEntry& At(size_t frame_num) const;
+
+  /* Returns number of the first frame which pts isn't less than given one.
+   * Returns Size() if there's no such frame.
+   */
+  size_t FrameNumber(int64_t pts) const;
+
+  /* Returns index of the video stream in the input;
+   */
+  int StreamIndex() const { return m_stream_idx; }
+
+  /* Returns stream time base numerator and denominator;
+   */
+  int TimeBaseNum() const { return m_tb_num; }
+  int TimeBaseDen() const { return m_tb_den; }
+
+private:
+  PacketIndex() = default;
+
+  // Entries are either stored in vector or memory mapped from file.
+  std::vector<PacketIndexEntry> m_entries;
+  std::shared_ptr<MappedFile> m_file;
+
+  const PacketIndexEntry* m_data = nullptr;
+  size_t m_size = 0U;
+
+  int m_stream_idx = -1;
+  int m_tb_num = 0;
+  int m_tb_den = 1;
+};
+} // namespace VPF
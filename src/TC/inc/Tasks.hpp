@@ -17,12 +17,16 @@
 #include "CodecsSupport.hpp"
 #include "MemoryInterfaces.hpp"
 #include "NvCodecCLIOptions.h"
+#include "PacketIndex.hpp"
 #include "TC_CORE.hpp"
 #include "tc_core_export.h" // generated by cmake
 
 extern "C" {
 #include <libavutil/frame.h>
 #include <libavformat/avio.h>
+
+struct AVCodecParameters;
+struct AVPacket;
 }
 
 #include "LibCuda.hpp"
@@ -103,6 +107,28 @@ enum NV_DEC_CAPS {
   NV_DEC_CAPS_NUM_ENTRIES
 };
 
+/* Codec parameters and time base of video stream. That's enough to set up
+ * decoder or muxer without opening the input.
+ */
+struct TC_CORE_EXPORT StreamParams {
+  std::shared_ptr<AVCodecParameters> codec_params;
+  AVRational time_base = {0, 1};
+
+  /* Makes deep copy of given codec parameters;
+   * Throws std::runtime_error in case of failure.
+   */
+  static StreamParams Make(const AVCodecParameters* codec_params,
+                           AVRational time_base);
+
+  /* Makes video stream parameters from codec name, e. g. "h264", frame size
+   * and codec extradata;
+   * Throws std::invalid_argument if codec is unknown.
+   */
+  static StreamParams Make(const std::string& codec, int width, int height,
+                           const std::vector<uint8_t>& extradata,
+                           AVRational time_base);
+};
+
 class TC_CORE_EXPORT DecodeFrame final : public Task {
 public:
   DecodeFrame() = delete;
@@ -113,6 +139,16 @@ public:
   TaskExecDetails GetSideData(AVFrameSideDataType);
 
   void GetParams(MuxingParams& params);
+
+  /* Returns immutable snapshot of stream parameters. It's cached and only
+   * rebuilt upon resolution change or packet index change, so it's cheap to
+   * call per frame.
+   */
+  std::shared_ptr<const MuxingParams> GetParamsSnapshot();
+
+  // Returns packet and frame counters alongside per-stage timings.
+  DecoderStats GetStats() const;
+
   uint32_t GetHostFrameSize() const;
   bool IsAccelerated() const;
   bool IsVFR() const;
@@ -121,13 +157,49 @@ public:
   static DecodeFrame* Make(const char* URL, NvDecoderClInterface& cli_iface,
                            std::optional<CUstream> stream,
                            std::shared_ptr<AVIOContext> p_io_ctx = nullptr);
+
+  /* Makes standalone decoder which has no input. Compressed packets are
+   * passed to it by user.
+   */
+  static DecodeFrame* Make(const StreamParams& params,
+                           NvDecoderClInterface& cli_iface,
+                           std::optional<CUstream> stream);
+
+  bool IsStandalone() const;
   const PacketData& GetLastPacketData() const;
 
+  /* Reads all video stream packets without decoding them and builds packet
+   * index which is then used for seek. Decoder is rewound to the beginning
+   * of the stream.
+   */
+  TaskExecDetails BuildIndex();
+
+  /* Set packet index to use for seek. Pass nullptr to stop using index.
+   * Throws std::invalid_argument if index doesn't match the input.
+   */
+  void SetIndex(std::shared_ptr<PacketIndex> index);
+  std::shared_ptr<PacketIndex> GetIndex() const;
+
+  /* Set decode mode. It takes effect starting from the next packet read from
+   * the input, so seek is advised after switching back to full decode.
+   */
+  void SetMode(DecodeMode mode);
+  DecodeMode GetMode() const;
+
+  /* Makes decoder output frames as soon as possible at the cost of decoding
+   * speed: demuxer doesn't buffer packets, codec doesn't use frame threading
+   * and has low delay flag set unless stream has B-frames. Codec is reopened,
+   * so it throws if decoding has started. Repeated call does nothing.
+   */
+  void SetLowDelay();
+
 private:
   /* 0) Reconstructed pixels
    * 1) Seek context
+   * 2) Compressed packet, standalone decoder only
+   * 3) Packet data, standalone decoder only
    */
-  static const uint32_t num_inputs = 2U;
+  static const uint32_t num_inputs = 4U;
 
   /* 0) Side data
    * 1) Reconstructed pixels in case of resolution change
@@ -138,6 +210,95 @@ private:
   DecodeFrame(const char* URL, NvDecoderClInterface& cli_iface,
               std::optional<CUstream> stream,
               std::shared_ptr<AVIOContext> p_io_ctx = nullptr);
+
+  DecodeFrame(const StreamParams& params, NvDecoderClInterface& cli_iface,
+              std::optional<CUstream> stream);
+};
+
+class TC_CORE_EXPORT DemuxFrame final : public Task {
+public:
+  DemuxFrame() = delete;
+  DemuxFrame(const DemuxFrame& other) = delete;
+  DemuxFrame& operator=(const DemuxFrame& other) = delete;
+
+  /* Reads next video packet from the input. Packets of other streams are
+   * skipped.
+   */
+  TaskExecDetails Run() final;
+
+  ~DemuxFrame() final;
+  static DemuxFrame* Make(const char* URL, NvDecoderClInterface& cli_iface,
+                          std::shared_ptr<AVIOContext> p_io_ctx = nullptr);
+
+  /* Returns new reference to last demuxed packet. Packet data isn't copied,
+   * it's shared by reference counting.
+   */
+  std::shared_ptr<AVPacket> GetLastPacket() const;
+  const PacketData& GetLastPacketData() const;
+
+  /* Seeks to the closest key frame at or before given timestamp. Timestamp
+   * is given in stream time base units.
+   */
+  TaskExecDetails Seek(int64_t timestamp);
+
+  const StreamParams& GetStreamParams() const;
+  int GetStreamIndex() const;
+  int GetNumStreams() const;
+
+  /* Returns start time of video stream in stream time base units, 0 if it's
+   * unknown.
+   */
+  int64_t GetStreamStartTime() const;
+
+private:
+  static const uint32_t num_inputs = 0U;
+  static const uint32_t num_outputs = 0U;
+  struct DemuxFrame_Impl* pImpl = nullptr;
+
+  DemuxFrame(const char* URL, NvDecoderClInterface& cli_iface,
+             std::shared_ptr<AVIOContext> p_io_ctx);
+};
+
+class TC_CORE_EXPORT MuxFrame final : public Task {
+public:
+  MuxFrame() = delete;
+  MuxFrame(const MuxFrame& other) = delete;
+  MuxFrame& operator=(const MuxFrame& other) = delete;
+
+  /* Writes compressed packet to the output. Packet timestamps are given in
+   * stream time base. In async mode packet is queued and written by
+   * background thread, so write error is reported by one of following calls.
+   */
+  TaskExecDetails Run() final;
+
+  /* Writes queued packets and container trailer. Nothing can be muxed after
+   * that. Called upon destruction if it wasn't called before.
+   */
+  TaskExecDetails Flush();
+
+  ~MuxFrame() final;
+
+  /* Opens the output and writes container header.
+   * Container format is guessed from URL unless it's given explicitly.
+   * Throws std::runtime_error in case of failure.
+   */
+  static MuxFrame* Make(const char* URL, const StreamParams& params,
+                        NvDecoderClInterface& cli_iface,
+                        const std::string& format = "", bool async = false);
+
+  bool IsAsync() const;
+
+private:
+  /* 0) Compressed packet
+   * 1) Packet data
+   */
+  static const uint32_t num_inputs = 2U;
+  static const uint32_t num_outputs = 0U;
+  struct MuxFrame_Impl* pImpl = nullptr;
+
+  MuxFrame(const char* URL, const StreamParams& params,
+           NvDecoderClInterface& cli_iface, const std::string& format,
+           bool async);
 };
 
 class TC_CORE_EXPORT CudaUploadFrame final : public Task {
@@ -211,6 +372,23 @@ public:
   static ConvertFrame* Make(uint32_t width, uint32_t height,
                             Pixel_Format inFormat, Pixel_Format outFormat);
 
+  /* Converts and scales in single pass.
+   * If number of threads isn't 1, frame is split into slices processed by
+   * libswscale worker threads. 0 means one thread per core.
+   */
+  static ConvertFrame* Make(uint32_t src_width, uint32_t src_height,
+                            uint32_t dst_width, uint32_t dst_height,
+                            Pixel_Format inFormat, Pixel_Format outFormat,
+                            ScalingAlgorithm algorithm,
+                            uint32_t num_threads = 1U);
+
+  /* NV12 and YUV420 to RGB_32F_PLANAR conversion without scaling produces
+   * (RGB / 255 - mean) / std for every channel. Default is [0; 1] range.
+   * Throws for other conversions.
+   */
+  void SetNormalization(const std::array<float, 3>& mean,
+                        const std::array<float, 3>& std);
+
   ~ConvertFrame();
 
   TaskExecDetails Run() final;
@@ -221,8 +399,10 @@ private:
 
   struct ConvertFrame_Impl* pImpl;
 
-  ConvertFrame(uint32_t width, uint32_t height, Pixel_Format inFormat,
-               Pixel_Format outFormat);
+  ConvertFrame(uint32_t src_width, uint32_t src_height, uint32_t dst_width,
+               uint32_t dst_height, Pixel_Format inFormat,
+               Pixel_Format outFormat, ScalingAlgorithm algorithm,
+               uint32_t num_threads);
 };
 
 class TC_CORE_EXPORT ResizeSurface final : public Task {
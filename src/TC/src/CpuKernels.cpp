@@ -0,0 +1,356 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CpuKernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/cpu.h>
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VALI_X86_KERNELS
+#include <immintrin.h>
+/* Kernels are compiled for their instruction set regardless of compiler
+ * flags, so that single binary runs everywhere. MSVC doesn't need that.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define VALI_TARGET(isa) __attribute__((target(isa)))
+#else
+#define VALI_TARGET(isa)
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VALI_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+namespace VPF {
+namespace {
+
+struct Row {
+  const uint8_t* y;
+  const uint8_t* u;
+  const uint8_t* v;
+  float* dst[3];
+};
+
+/* Every kernel converts as many pixels from the beginning of the row as it
+ * can and returns their number. The rest is converted by scalar code.
+ */
+using RowFunc = int (*)(const Row& row, int uv_step, int width,
+                        const YuvToRgbCoeffs& c);
+
+void convertPixels(const Row& row, int uv_step, int from, int to,
+                   const YuvToRgbCoeffs& c) {
+  for (auto x = from; x < to; x++) {
+    auto const uv = (x / 2) * uv_step;
+    auto const yf = row.y[x] * c.y_scale + c.y_offset;
+    auto const uf = row.u[uv] * c.c_scale + c.c_offset;
+    auto const vf = row.v[uv] * c.c_scale + c.c_offset;
+
+    const float rgb[3] = {yf + c.r_v * vf, yf + c.g_u * uf + c.g_v * vf,
+                          yf + c.b_u * uf};
+    for (auto i = 0; i < 3; i++) {
+      row.dst[i][x] = std::clamp(rgb[i], 0.f, 255.f) * c.scale[i] + c.offset[i];
+    }
+  }
+}
+
+int rowScalar(const Row&, int, int, const YuvToRgbCoeffs&) { return 0; }
+
+#ifdef VALI_X86_KERNELS
+VALI_TARGET("avx2,fma")
+int rowAvx2(const Row& row, int uv_step, int width, const YuvToRgbCoeffs& c) {
+  auto const y_scale = _mm256_set1_ps(c.y_scale);
+  auto const y_offset = _mm256_set1_ps(c.y_offset);
+  auto const c_scale = _mm256_set1_ps(c.c_scale);
+  auto const c_offset = _mm256_set1_ps(c.c_offset);
+  auto const r_v = _mm256_set1_ps(c.r_v);
+  auto const g_u = _mm256_set1_ps(c.g_u);
+  auto const g_v = _mm256_set1_ps(c.g_v);
+  auto const b_u = _mm256_set1_ps(c.b_u);
+  auto const lo = _mm256_setzero_ps();
+  auto const hi = _mm256_set1_ps(255.f);
+
+  __m256 scale[3], offset[3];
+  for (auto i = 0; i < 3; i++) {
+    scale[i] = _mm256_set1_ps(c.scale[i]);
+    offset[i] = _mm256_set1_ps(c.offset[i]);
+  }
+
+  // Duplicate every chroma sample of interleaved NV12 UV pairs.
+  auto const u_mask =
+      _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+  auto const v_mask =
+      _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  auto x = 0;
+  for (; x + 8 <= width; x += 8) {
+    auto const y8 = _mm_loadl_epi64((const __m128i*)(row.y + x));
+
+    __m128i u8, v8;
+    if (1 == uv_step) {
+      int32_t u4, v4;
+      std::memcpy(&u4, row.u + x / 2, sizeof(u4));
+      std::memcpy(&v4, row.v + x / 2, sizeof(v4));
+      u8 = _mm_cvtsi32_si128(u4);
+      v8 = _mm_cvtsi32_si128(v4);
+      u8 = _mm_unpacklo_epi8(u8, u8);
+      v8 = _mm_unpacklo_epi8(v8, v8);
+    } else {
+      auto const uv = _mm_loadl_epi64((const __m128i*)(row.u + x));
+      u8 = _mm_shuffle_epi8(uv, u_mask);
+      v8 = _mm_shuffle_epi8(uv, v_mask);
+    }
+
+    auto const yf = _mm256_fmadd_ps(
+        _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(y8)), y_scale, y_offset);
+    auto const uf = _mm256_fmadd_ps(
+        _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(u8)), c_scale, c_offset);
+    auto const vf = _mm256_fmadd_ps(
+        _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v8)), c_scale, c_offset);
+
+    const __m256 rgb[3] = {
+        _mm256_fmadd_ps(vf, r_v, yf),
+        _mm256_fmadd_ps(uf, g_u, _mm256_fmadd_ps(vf, g_v, yf)),
+        _mm256_fmadd_ps(uf, b_u, yf)};
+
+    for (auto i = 0; i < 3; i++) {
+      auto const val = _mm256_min_ps(_mm256_max_ps(rgb[i], lo), hi);
+      _mm256_storeu_ps(row.dst[i] + x,
+                       _mm256_fmadd_ps(val, scale[i], offset[i]));
+    }
+  }
+
+  return x;
+}
+
+VALI_TARGET("avx2,fma,avx512f")
+int rowAvx512(const Row& row, int uv_step, int width,
+              const YuvToRgbCoeffs& c) {
+  auto const y_scale = _mm512_set1_ps(c.y_scale);
+  auto const y_offset = _mm512_set1_ps(c.y_offset);
+  auto const c_scale = _mm512_set1_ps(c.c_scale);
+  auto const c_offset = _mm512_set1_ps(c.c_offset);
+  auto const r_v = _mm512_set1_ps(c.r_v);
+  auto const g_u = _mm512_set1_ps(c.g_u);
+  auto const g_v = _mm512_set1_ps(c.g_v);
+  auto const b_u = _mm512_set1_ps(c.b_u);
+  auto const lo = _mm512_setzero_ps();
+  auto const hi = _mm512_set1_ps(255.f);
+
+  __m512 scale[3], offset[3];
+  for (auto i = 0; i < 3; i++) {
+    scale[i] = _mm512_set1_ps(c.scale[i]);
+    offset[i] = _mm512_set1_ps(c.offset[i]);
+  }
+
+  auto const u_mask =
+      _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+  auto const v_mask =
+      _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+
+  auto x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto const y16 = _mm_loadu_si128((const __m128i*)(row.y + x));
+
+    __m128i u16, v16;
+    if (1 == uv_step) {
+      u16 = _mm_loadl_epi64((const __m128i*)(row.u + x / 2));
+      v16 = _mm_loadl_epi64((const __m128i*)(row.v + x / 2));
+      u16 = _mm_unpacklo_epi8(u16, u16);
+      v16 = _mm_unpacklo_epi8(v16, v16);
+    } else {
+      auto const uv = _mm_loadu_si128((const __m128i*)(row.u + x));
+      u16 = _mm_shuffle_epi8(uv, u_mask);
+      v16 = _mm_shuffle_epi8(uv, v_mask);
+    }
+
+    auto const yf = _mm512_fmadd_ps(
+        _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(y16)), y_scale, y_offset);
+    auto const uf = _mm512_fmadd_ps(
+        _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(u16)), c_scale, c_offset);
+    auto const vf = _mm512_fmadd_ps(
+        _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(v16)), c_scale, c_offset);
+
+    const __m512 rgb[3] = {
+        _mm512_fmadd_ps(vf, r_v, yf),
+        _mm512_fmadd_ps(uf, g_u, _mm512_fmadd_ps(vf, g_v, yf)),
+        _mm512_fmadd_ps(uf, b_u, yf)};
+
+    for (auto i = 0; i < 3; i++) {
+      auto const val = _mm512_min_ps(_mm512_max_ps(rgb[i], lo), hi);
+      _mm512_storeu_ps(row.dst[i] + x,
+                       _mm512_fmadd_ps(val, scale[i], offset[i]));
+    }
+  }
+
+  return x;
+}
+#endif
+
+#ifdef VALI_NEON_KERNELS
+int rowNeon(const Row& row, int uv_step, int width, const YuvToRgbCoeffs& c) {
+  auto const y_scale = vdupq_n_f32(c.y_scale);
+  auto const y_offset = vdupq_n_f32(c.y_offset);
+  auto const c_scale = vdupq_n_f32(c.c_scale);
+  auto const c_offset = vdupq_n_f32(c.c_offset);
+  auto const r_v = vdupq_n_f32(c.r_v);
+  auto const g_u = vdupq_n_f32(c.g_u);
+  auto const g_v = vdupq_n_f32(c.g_v);
+  auto const b_u = vdupq_n_f32(c.b_u);
+  auto const lo = vdupq_n_f32(0.f);
+  auto const hi = vdupq_n_f32(255.f);
+
+  float32x4_t scale[3], offset[3];
+  for (auto i = 0; i < 3; i++) {
+    scale[i] = vdupq_n_f32(c.scale[i]);
+    offset[i] = vdupq_n_f32(c.offset[i]);
+  }
+
+  auto to_float = [](uint8x8_t src, float32x4_t& low, float32x4_t& high) {
+    auto const wide = vmovl_u8(src);
+    low = vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+    high = vcvtq_f32_u32(vmovl_high_u16(wide));
+  };
+
+  auto x = 0;
+  for (; x + 8 <= width; x += 8) {
+    auto const y8 = vld1_u8(row.y + x);
+
+    uint8x8_t u8, v8;
+    if (1 == uv_step) {
+      uint32_t u4, v4;
+      std::memcpy(&u4, row.u + x / 2, sizeof(u4));
+      std::memcpy(&v4, row.v + x / 2, sizeof(v4));
+      u8 = vreinterpret_u8_u32(vdup_n_u32(u4));
+      v8 = vreinterpret_u8_u32(vdup_n_u32(v4));
+    } else {
+      auto const uv = vld1_u8(row.u + x);
+      u8 = vuzp1_u8(uv, uv);
+      v8 = vuzp2_u8(uv, uv);
+    }
+    u8 = vzip1_u8(u8, u8);
+    v8 = vzip1_u8(v8, v8);
+
+    float32x4_t yf[2], uf[2], vf[2];
+    to_float(y8, yf[0], yf[1]);
+    to_float(u8, uf[0], uf[1]);
+    to_float(v8, vf[0], vf[1]);
+
+    for (auto h = 0; h < 2; h++) {
+      auto const yh = vfmaq_f32(y_offset, yf[h], y_scale);
+      auto const uh = vfmaq_f32(c_offset, uf[h], c_scale);
+      auto const vh = vfmaq_f32(c_offset, vf[h], c_scale);
+
+      const float32x4_t rgb[3] = {
+          vfmaq_f32(yh, vh, r_v), vfmaq_f32(vfmaq_f32(yh, vh, g_v), uh, g_u),
+          vfmaq_f32(yh, uh, b_u)};
+
+      for (auto i = 0; i < 3; i++) {
+        auto const val = vminq_f32(vmaxq_f32(rgb[i], lo), hi);
+        vst1q_f32(row.dst[i] + x + 4 * h, vfmaq_f32(offset[i], val, scale[i]));
+      }
+    }
+  }
+
+  return x;
+}
+#endif
+
+RowFunc getRowFunc(CpuKernelIsa isa) {
+  switch (isa) {
+#ifdef VALI_X86_KERNELS
+  case CpuKernelIsa::AVX2:
+    return rowAvx2;
+  case CpuKernelIsa::AVX512:
+    return rowAvx512;
+#endif
+#ifdef VALI_NEON_KERNELS
+  case CpuKernelIsa::NEON:
+    return rowNeon;
+#endif
+  default:
+    return rowScalar;
+  }
+}
+} // namespace
+
+CpuKernelIsa getCpuKernelIsa() {
+#if defined(VALI_X86_KERNELS)
+  auto const flags = av_get_cpu_flags();
+  if (flags & AV_CPU_FLAG_AVX512) {
+    return CpuKernelIsa::AVX512;
+  }
+  if ((flags & AV_CPU_FLAG_AVX2) && (flags & AV_CPU_FLAG_FMA3)) {
+    return CpuKernelIsa::AVX2;
+  }
+#elif defined(VALI_NEON_KERNELS)
+  if (av_get_cpu_flags() & AV_CPU_FLAG_NEON) {
+    return CpuKernelIsa::NEON;
+  }
+#endif
+  return CpuKernelIsa::SCALAR;
+}
+
+YuvToRgbCoeffs makeYuvToRgbCoeffs(bool is_bt709, bool is_jpeg_range,
+                                  const std::array<float, 3>& mean,
+                                  const std::array<float, 3>& std) {
+  auto const kr = is_bt709 ? 0.2126f : 0.299f;
+  auto const kb = is_bt709 ? 0.0722f : 0.114f;
+  auto const kg = 1.f - kr - kb;
+
+  YuvToRgbCoeffs c;
+
+  // Limited range luma takes [16; 235] and chroma takes [16; 240].
+  c.y_scale = is_jpeg_range ? 1.f : 255.f / 219.f;
+  c.y_offset = is_jpeg_range ? 0.f : -16.f * c.y_scale;
+  c.c_scale = is_jpeg_range ? 1.f : 255.f / 224.f;
+  c.c_offset = -128.f * c.c_scale;
+
+  c.r_v = 2.f * (1.f - kr);
+  c.b_u = 2.f * (1.f - kb);
+  c.g_u = -c.b_u * kb / kg;
+  c.g_v = -c.r_v * kr / kg;
+
+  for (auto i = 0; i < 3; i++) {
+    c.scale[i] = 1.f / (255.f * std[i]);
+    c.offset[i] = -mean[i] / std[i];
+  }
+
+  return c;
+}
+
+void yuvToRgbPlanarF32(const YuvPlanes& src, float* dst, int width,
+                       int height, const YuvToRgbCoeffs& coeffs,
+                       CpuKernelIsa isa) {
+  auto const row_func = getRowFunc(isa);
+  auto const plane_size = (size_t)width * height;
+
+  for (auto y = 0; y < height; y++) {
+    Row row;
+    row.y = src.y + (size_t)y * src.y_pitch;
+    row.u = src.u + (size_t)(y / 2) * src.uv_pitch;
+    row.v = src.v + (size_t)(y / 2) * src.uv_pitch;
+    for (auto i = 0; i < 3; i++) {
+      row.dst[i] = dst + i * plane_size + (size_t)y * width;
+    }
+
+    auto const done = row_func(row, src.uv_step, width, coeffs);
+    convertPixels(row, src.uv_step, done, width, coeffs);
+  }
+}
+} // namespace VPF
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DecodeThreadBudget.hpp"
+
+#include <algorithm>
+
+namespace VPF {
+
+DecodeThreadBudget& DecodeThreadBudget::Instance() {
+  static DecodeThreadBudget instance;
+  return instance;
+}
+
+void DecodeThreadBudget::SetNumCores(uint32_t num_cores) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_num_cores = num_cores;
+}
+
+uint32_t DecodeThreadBudget::GetNumCores() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_num_cores;
+}
+
+uint32_t DecodeThreadBudget::Acquire(int64_t weight) {
+  weight = std::max(weight, (int64_t)1);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_num_active++;
+  m_total_weight += weight;
+
+  if (!m_num_cores) {
+    return 0U;
+  }
+
+  /* Threads given to running decoders aren't returned until they release
+   * them, so share is capped by cores which are still free. Every decoder
+   * needs at least one thread, so cores may still be oversubscribed if
+   * there are more decoders than cores.
+   */
+  auto const share = (double)m_num_cores * weight / m_total_weight;
+  auto const num_free =
+      m_num_cores > m_num_threads ? m_num_cores - m_num_threads : 0U;
+  auto const num_threads = std::clamp(
+      std::min((uint32_t)(share + 0.5), num_free), 1U,
+      std::min(m_num_cores, max_threads));
+
+  m_num_threads += num_threads;
+  return num_threads;
+}
+
+void DecodeThreadBudget::Release(int64_t weight, uint32_t num_threads) {
+  weight = std::max(weight, (int64_t)1);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_num_active) {
+    m_num_active--;
+    m_total_weight = std::max(m_total_weight - weight, (int64_t)0);
+    m_num_threads -= std::min(num_threads, m_num_threads);
+  }
+}
+
+uint32_t DecodeThreadBudget::NumActive() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_num_active;
+}
+} // namespace VPF
@@ -14,6 +14,7 @@
  */
 
 #include "Surfaces.hpp"
+#include "Utils.hpp"
 #include <algorithm>
 #include <cstring>
 #include <iostream>
@@ -21,6 +22,12 @@
 #include <sstream>
 #include <stdexcept>
 
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
 using namespace VPF;
 using namespace std;
 
@@ -455,4 +462,158 @@ bool Surface::Empty() const {
                      [&](const SurfacePlane& plane) { return plane.Empty(); });
 }
 
-CUcontext Surface::Context() { return GetSurfacePlane().Context(); }
\ No newline at end of file
+CUcontext Surface::Context() { return GetSurfacePlane().Context(); }
+
+HostFrame* HostFrame::Make() { return new HostFrame(); }
+
+HostFrame::~HostFrame() = default;
+
+bool HostFrame::Empty() const { return !m_frame || !m_frame->data[0]; }
+
+void HostFrame::Update(const AVFrame* src) {
+  if (!src) {
+    throw std::invalid_argument("HostFrame: empty source frame");
+  }
+
+  auto frame = av_frame_clone(src);
+  if (!frame) {
+    throw std::bad_alloc();
+  }
+
+  m_frame = std::shared_ptr<AVFrame>(
+      frame, [](AVFrame* p) { av_frame_free(&p); });
+}
+
+HostFrame* HostFrame::Clone() const {
+  auto copy = HostFrame::Make();
+  copy->m_frame = m_frame;
+  return copy;
+}
+
+Pixel_Format HostFrame::PixelFormat() const {
+  if (Empty()) {
+    return UNDEFINED;
+  }
+
+  auto const format = (AVPixelFormat)m_frame->format;
+  switch (format) {
+  case AV_PIX_FMT_YUVJ420P:
+    return YUV420;
+  default:
+    return fromFfmpegPixelFormat(format);
+  }
+}
+
+uint32_t HostFrame::NumPlanes() const {
+  if (Empty()) {
+    return 0U;
+  }
+
+  auto const res = av_pix_fmt_count_planes((AVPixelFormat)m_frame->format);
+  return res < 0 ? 0U : res;
+}
+
+uint32_t HostFrame::ElemSize() const {
+  if (Empty()) {
+    return 0U;
+  }
+
+  auto desc = av_pix_fmt_desc_get((AVPixelFormat)m_frame->format);
+  return desc ? (desc->comp[0].depth + 7) / 8 : 0U;
+}
+
+DLDataTypeCode HostFrame::DataType() const {
+  if (Empty()) {
+    return kDLUInt;
+  }
+
+  auto desc = av_pix_fmt_desc_get((AVPixelFormat)m_frame->format);
+  return (desc && (desc->flags & AV_PIX_FMT_FLAG_FLOAT)) ? kDLFloat : kDLUInt;
+}
+
+uint32_t HostFrame::Width(uint32_t plane) const {
+  if (plane >= NumPlanes()) {
+    return 0U;
+  }
+
+  auto const linesize = av_image_get_linesize((AVPixelFormat)m_frame->format,
+                                              m_frame->width, plane);
+  return linesize < 0 ? 0U : linesize / ElemSize();
+}
+
+uint32_t HostFrame::Height(uint32_t plane) const {
+  if (plane >= NumPlanes()) {
+    return 0U;
+  }
+
+  // Chroma planes of YUV formats are the only subsampled ones.
+  auto desc = av_pix_fmt_desc_get((AVPixelFormat)m_frame->format);
+  auto const is_chroma = (plane == 1U || plane == 2U) &&
+                         !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+
+  return is_chroma ? AV_CEIL_RSHIFT(m_frame->height, desc->log2_chroma_h)
+                   : m_frame->height;
+}
+
+uint32_t HostFrame::Pitch(uint32_t plane) const {
+  return plane < NumPlanes() ? m_frame->linesize[plane] : 0U;
+}
+
+uint8_t* HostFrame::Data(uint32_t plane) const {
+  return plane < NumPlanes() ? m_frame->data[plane] : nullptr;
+}
+
+size_t HostFrame::HostMemSize() const {
+  size_t size = 0U;
+  for (auto i = 0U; i < NumPlanes(); i++) {
+    size += Width(i) * Height(i) * ElemSize();
+  }
+
+  return size;
+}
+
+static void HostFrame_DLManagedTensor_Destroy(DLManagedTensor* self) {
+  if (!self) {
+    return;
+  }
+
+  delete[] self->dl_tensor.shape;
+  delete[] self->dl_tensor.strides;
+  delete static_cast<std::shared_ptr<AVFrame>*>(self->manager_ctx);
+  delete self;
+}
+
+DLManagedTensor* HostFrame::ToDLPack(uint32_t plane) {
+  if (plane >= NumPlanes()) {
+    std::stringstream ss;
+    ss << "HostFrame: invalid plane number " << plane;
+    throw std::invalid_argument(ss.str());
+  }
+
+  auto dlmt = new DLManagedTensor();
+  memset((void*)dlmt, 0, sizeof(*dlmt));
+
+  // Tensor holds AVFrame reference to keep the memory alive.
+  dlmt->manager_ctx = new std::shared_ptr<AVFrame>(m_frame);
+  dlmt->deleter = HostFrame_DLManagedTensor_Destroy;
+
+  dlmt->dl_tensor.device.device_type = kDLCPU;
+  dlmt->dl_tensor.device.device_id = 0;
+  dlmt->dl_tensor.data = (void*)Data(plane);
+  dlmt->dl_tensor.ndim = 2;
+  dlmt->dl_tensor.byte_offset = 0U;
+
+  dlmt->dl_tensor.dtype.code = DataType();
+  dlmt->dl_tensor.dtype.bits = ElemSize() * 8U;
+  dlmt->dl_tensor.dtype.lanes = 1;
+
+  dlmt->dl_tensor.shape = new int64_t[dlmt->dl_tensor.ndim];
+  dlmt->dl_tensor.shape[0] = Height(plane);
+  dlmt->dl_tensor.shape[1] = Width(plane);
+
+  dlmt->dl_tensor.strides = new int64_t[dlmt->dl_tensor.ndim];
+  dlmt->dl_tensor.strides[0] = Pitch(plane) / ElemSize();
+  dlmt->dl_tensor.strides[1] = 1;
+
+  return dlmt;
+}
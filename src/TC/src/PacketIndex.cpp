@@ -0,0 +1,248 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PacketIndex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VPF {
+namespace {
+/* Index file starts with this header followed by entries.
+ * All values are stored in host byte order.
+ */
+struct PacketIndexHeader {
+  char magic[8];
+  uint32_t version;
+  int32_t stream_idx;
+  int32_t tb_num;
+  int32_t tb_den;
+  uint64_t num_entries;
+};
+
+static_assert(sizeof(PacketIndexHeader) == 32U,
+              "PacketIndexHeader layout is a part of index file format");
+
+constexpr char index_magic[8] = {'V', 'A', 'L', 'I', 'I', 'D', 'X', '\0'};
+constexpr uint32_t index_version = 1U;
+} // namespace
+
+/* Read-only memory mapping of the whole file.
+ */
+class MappedFile {
+public:
+  MappedFile(const std::string& path) {
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == m_file) {
+      throw std::runtime_error("Can't open file " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size)) {
+      CloseHandle(m_file);
+      throw std::runtime_error("Can't get size of file " + path);
+    }
+    m_size = size.QuadPart;
+
+    if (m_size) {
+      m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+      m_data = m_mapping
+                   ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)
+                   : nullptr;
+      if (!m_data) {
+        if (m_mapping) {
+          CloseHandle(m_mapping);
+        }
+        CloseHandle(m_file);
+        throw std::runtime_error("Can't map file " + path);
+      }
+    }
+#else
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+      throw std::runtime_error("Can't open file " + path);
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) < 0) {
+      close(m_fd);
+      throw std::runtime_error("Can't get size of file " + path);
+    }
+    m_size = st.st_size;
+
+    if (m_size) {
+      m_data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+      if (MAP_FAILED == m_data) {
+        close(m_fd);
+        throw std::runtime_error("Can't map file " + path);
+      }
+    }
+#endif
+  }
+
+  ~MappedFile() {
+#ifdef _WIN32
+    if (m_data) {
+      UnmapViewOfFile(m_data);
+      CloseHandle(m_mapping);
+    }
+    CloseHandle(m_file);
+#else
+    if (m_data) {
+      munmap(m_data, m_size);
+    }
+    close(m_fd);
+#endif
+  }
+
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  const uint8_t* Data() const { return static_cast<const uint8_t*>(m_data); }
+  size_t Size() const { return m_size; }
+
+private:
+#ifdef _WIN32
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = NULL;
+#else
+  int m_fd = -1;
+#endif
+  void* m_data = nullptr;
+  size_t m_size = 0U;
+};
+
+PacketIndex::~PacketIndex() = default;
+
+PacketIndex* PacketIndex::Make(std::vector<PacketIndexEntry>&& entries,
+                               int stream_idx, int tb_num, int tb_den) {
+  auto index = new PacketIndex();
+  index->m_entries = std::move(entries);
+  index->m_stream_idx = stream_idx;
+  index->m_tb_num = tb_num;
+  index->m_tb_den = tb_den;
+
+  auto& vec = index->m_entries;
+  std::stable_sort(vec.begin(), vec.end(),
+                   [](const PacketIndexEntry& a, const PacketIndexEntry& b) {
+                     return a.pts < b.pts;
+                   });
+
+  /* Frames preceding the first key frame in presentation order can only be
+   * reconstructed by decoding from the very beginning.
+   */
+  int64_t key_num = 0;
+  for (size_t i = 0U; i < vec.size(); i++) {
+    if (vec[i].key) {
+      key_num = i;
+    }
+    vec[i].key_num = key_num;
+  }
+
+  index->m_data = vec.data();
+  index->m_size = vec.size();
+  return index;
+}
+
+PacketIndex* PacketIndex::Load(const std::string& path) {
+  auto file = std::make_shared<MappedFile>(path);
+
+  PacketIndexHeader header;
+  if (file->Size() < sizeof(header)) {
+    throw std::runtime_error("Index file " + path + " is truncated");
+  }
+  memcpy(&header, file->Data(), sizeof(header));
+
+  if (memcmp(header.magic, index_magic, sizeof(index_magic))) {
+    throw std::runtime_error(path + " is not an index file");
+  }
+
+  if (header.version != index_version) {
+    std::stringstream ss;
+    ss << "Unsupported index file version: " << header.version;
+    throw std::runtime_error(ss.str());
+  }
+
+  if ((file->Size() - sizeof(header)) / sizeof(PacketIndexEntry) <
+      header.num_entries) {
+    throw std::runtime_error("Index file " + path + " is truncated");
+  }
+
+  auto index = new PacketIndex();
+  index->m_file = file;
+  index->m_stream_idx = header.stream_idx;
+  index->m_tb_num = header.tb_num;
+  index->m_tb_den = header.tb_den;
+  index->m_size = header.num_entries;
+  index->m_data = reinterpret_cast<const PacketIndexEntry*>(file->Data() +
+                                                            sizeof(header));
+  return index;
+}
+
+void PacketIndex::Save(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Can't open file " + path);
+  }
+
+  PacketIndexHeader header = {};
+  memcpy(header.magic, index_magic, sizeof(index_magic));
+  header.version = index_version;
+  header.stream_idx = m_stream_idx;
+  header.tb_num = m_tb_num;
+  header.tb_den = m_tb_den;
+  header.num_entries = m_size;
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(m_data),
+             m_size * sizeof(PacketIndexEntry));
+
+  if (!file) {
+    throw std::runtime_error("Can't write index to file " + path);
+  }
+}
+
+const PacketIndexEntry& PacketIndex::At(size_t frame_num) const {
+  if (frame_num >= m_size) {
+    std::stringstream ss;
+    ss << "Frame number " << frame_num << " is out of index bounds";
+    throw std::out_of_range(ss.str());
+  }
+
+  return m_data[frame_num];
+}
+
+size_t PacketIndex::FrameNumber(int64_t pts) const {
+  auto it = std::lower_bound(
+      m_data, m_data + m_size, pts,
+      [](const PacketIndexEntry& entry, int64_t pts) {
+        return entry.pts < pts;
+      });
+  return it - m_data;
+}
+} // namespace VPF
@@ -1,50 +1,325 @@
+#include "CpuKernels.hpp"
 #include "Tasks.hpp"
 #include "Utils.hpp"
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <tuple>
 
 extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
 #include <libswscale/swscale.h>
 }
 
 namespace VPF {
+static int toSwsFlags(ScalingAlgorithm algorithm) {
+  switch (algorithm) {
+  case ScalingAlgorithm::FAST_BILINEAR:
+    return SWS_FAST_BILINEAR;
+  case ScalingAlgorithm::BILINEAR:
+    return SWS_BILINEAR;
+  case ScalingAlgorithm::BICUBIC:
+    return SWS_BICUBIC;
+  case ScalingAlgorithm::NEAREST:
+    return SWS_POINT;
+  case ScalingAlgorithm::AREA:
+    return SWS_AREA;
+  case ScalingAlgorithm::LANCZOS:
+    return SWS_LANCZOS;
+  case ScalingAlgorithm::SPLINE:
+    return SWS_SPLINE;
+  default:
+    throw std::invalid_argument("ConvertFrame: unknown scaling algorithm");
+  }
+}
+
+/* Everything SwsContext is initialized with. Contexts with same key are
+ * interchangeable.
+ */
+struct SwsKey {
+  int src_width, src_height, src_fmt;
+  int dst_width, dst_height, dst_fmt;
+  int flags;
+  int num_threads;
+  int color_space;
+  bool is_jpeg_range;
+
+  auto Tie() const {
+    return std::tie(src_width, src_height, src_fmt, dst_width, dst_height,
+                    dst_fmt, flags, num_threads, color_space, is_jpeg_range);
+  }
+
+  bool operator==(const SwsKey& other) const { return Tie() == other.Tie(); }
+};
+
+/* Process-wide pool of idle SwsContexts, so that converters of streams with
+ * same parameters don't initialize their own contexts.
+ *
+ * Context can't be used by multiple threads at once, so it's taken from the
+ * pool for exclusive use and is returned back when converter doesn't need
+ * it any more.
+ */
+class SwsContextPool {
+public:
+  /* Never destroyed, converters may outlive static objects upon exit.
+   */
+  static SwsContextPool& Instance() {
+    static auto pool = new SwsContextPool();
+    return *pool;
+  }
+
+  /* Returns idle context with given key or makes new one.
+   * Returns nullptr if colorspace details aren't supported.
+   * Throws std::runtime_error if context can't be created.
+   */
+  SwsContext* Acquire(const SwsKey& key) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Most recently released contexts are at the back.
+      for (auto it = m_idle.rbegin(); it != m_idle.rend(); it++) {
+        if (it->first == key) {
+          auto ctx = it->second;
+          m_idle.erase(std::next(it).base());
+          return ctx;
+        }
+      }
+    }
+
+    return Make(key);
+  }
+
+  void Release(const SwsKey& key, SwsContext* ctx) {
+    if (!ctx) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.emplace_back(key, ctx);
+    if (m_idle.size() > max_idle) {
+      sws_freeContext(m_idle.front().second);
+      m_idle.pop_front();
+    }
+  }
+
+private:
+  SwsContextPool() = default;
+
+  static SwsContext* Make(const SwsKey& key) {
+    /* Number of threads has to be set before initialization, so context is
+     * configured with AVOptions instead of sws_getContext.
+     */
+    auto ctx = sws_alloc_context();
+    if (!ctx) {
+      throw std::runtime_error("ConvertFrame: sws_alloc_context failed");
+    }
+
+    av_opt_set_int(ctx, "srcw", key.src_width, 0);
+    av_opt_set_int(ctx, "srch", key.src_height, 0);
+    av_opt_set_int(ctx, "src_format", key.src_fmt, 0);
+    av_opt_set_int(ctx, "dstw", key.dst_width, 0);
+    av_opt_set_int(ctx, "dsth", key.dst_height, 0);
+    av_opt_set_int(ctx, "dst_format", key.dst_fmt, 0);
+    av_opt_set_int(ctx, "sws_flags", key.flags, 0);
+    av_opt_set_int(ctx, "threads", key.num_threads, 0);
+
+    if (sws_init_context(ctx, nullptr, nullptr) < 0) {
+      sws_freeContext(ctx);
+      throw std::runtime_error("ConvertFrame: sws_init_context failed");
+    }
+
+    auto const brightness = 0U, contrast = 1U << 16U, saturation = 1U << 16U;
+    auto err = sws_setColorspaceDetails(
+        ctx, sws_getCoefficients(key.color_space), key.is_jpeg_range,
+        sws_getCoefficients(key.color_space), key.is_jpeg_range, brightness,
+        contrast, saturation);
+    if (err < 0) {
+      sws_freeContext(ctx);
+      return nullptr;
+    }
+
+    return ctx;
+  }
+
+  static constexpr size_t max_idle = 16U;
+
+  std::mutex m_mutex;
+  std::deque<std::pair<SwsKey, SwsContext*>> m_idle;
+};
+
+/* Makes frame reference counted without taking ownership of the memory.
+ * libswscale frame API copies frames which aren't reference counted.
+ */
+static void refBuffer(AVFrame& frame, Buffer& buf, int width, int height,
+                      AVPixelFormat format, int flags) {
+  frame.buf[0] = av_buffer_create(
+      buf.GetDataAs<uint8_t>(), buf.GetRawMemSize(),
+      [](void* opaque, uint8_t* data) {}, nullptr, flags);
+  if (!frame.buf[0]) {
+    throw std::bad_alloc();
+  }
+
+  frame.width = width;
+  frame.height = height;
+  frame.format = format;
+}
+
 struct ConvertFrame_Impl {
   const AVPixelFormat m_src_fmt, m_dst_fmt;
-  size_t m_width, m_height;
+  size_t m_src_width, m_src_height;
+  size_t m_dst_width, m_dst_height;
+  uint32_t m_num_threads;
+
+  /* Context with colorspace details applied. It's only replaced when
+   * colorspace or color range change, so they aren't set every frame.
+   */
+  SwsKey m_key;
+  SwsContext* m_ctx = nullptr;
 
-  std::shared_ptr<SwsContext> m_ctx = nullptr;
+  /* NV12 and YUV420 to RGB_32F_PLANAR conversion without scaling is done by
+   * fused kernel which also normalizes the output, libswscale isn't used for
+   * it.
+   */
+  bool m_use_kernel = false;
+  std::array<float, 3> m_mean = {0.f, 0.f, 0.f};
+  std::array<float, 3> m_std = {1.f, 1.f, 1.f};
 
-  ConvertFrame_Impl(uint32_t width, uint32_t height, Pixel_Format in_Format,
-                    Pixel_Format out_Format)
+  ConvertFrame_Impl(uint32_t src_width, uint32_t src_height,
+                    uint32_t dst_width, uint32_t dst_height,
+                    Pixel_Format in_Format, Pixel_Format out_Format,
+                    ScalingAlgorithm algorithm, uint32_t num_threads)
       : m_src_fmt(toFfmpegPixelFormat(in_Format)),
-        m_dst_fmt(toFfmpegPixelFormat(out_Format)), m_width(width),
-        m_height(height) {
-    m_ctx.reset(sws_getContext(m_width, m_height, m_src_fmt, width, height,
-                               m_dst_fmt, SWS_BILINEAR, nullptr, nullptr,
-                               nullptr),
-                [](auto* p) { sws_freeContext(p); });
+        m_dst_fmt(toFfmpegPixelFormat(out_Format)), m_src_width(src_width),
+        m_src_height(src_height), m_dst_width(dst_width),
+        m_dst_height(dst_height), m_num_threads(num_threads) {
+    m_key.src_width = m_src_width;
+    m_key.src_height = m_src_height;
+    m_key.src_fmt = m_src_fmt;
+    m_key.dst_width = m_dst_width;
+    m_key.dst_height = m_dst_height;
+    m_key.dst_fmt = m_dst_fmt;
+    m_key.flags = toSwsFlags(algorithm);
+    m_key.num_threads = m_num_threads;
+
+    // libswscale defaults, they are replaced upon first run if needed.
+    m_key.color_space = SWS_CS_DEFAULT;
+    m_key.is_jpeg_range = false;
+
+    m_use_kernel = (RGB_32F_PLANAR == out_Format) &&
+                   (NV12 == in_Format || YUV420 == in_Format) &&
+                   src_width == dst_width && src_height == dst_height;
+    if (m_use_kernel) {
+      return;
+    }
+
+    // Throws if conversion isn't supported.
+    m_ctx = SwsContextPool::Instance().Acquire(m_key);
+  }
+
+  ~ConvertFrame_Impl() { SwsContextPool::Instance().Release(m_key, m_ctx); }
 
-    if (!m_ctx) {
-      throw std::runtime_error("ConvertFrame: sws_getContext failed");
+  /* Returns context with given colorspace details or nullptr if they aren't
+   * supported.
+   */
+  SwsContext* GetContext(int color_space, bool is_jpeg_range) {
+    if (m_ctx && color_space == m_key.color_space &&
+        is_jpeg_range == m_key.is_jpeg_range) {
+      return m_ctx;
     }
+
+    auto& pool = SwsContextPool::Instance();
+    pool.Release(m_key, m_ctx);
+    m_ctx = nullptr;
+
+    m_key.color_space = color_space;
+    m_key.is_jpeg_range = is_jpeg_range;
+    m_ctx = pool.Acquire(m_key);
+    return m_ctx;
+  }
+
+  // Returns false if buffers sizes don't match.
+  bool RunKernel(Buffer* src_buf, Buffer* dst_buf,
+                 const ColorspaceConversionContext& cc_ctx) {
+    auto const width = (int)m_src_width;
+    auto const height = (int)m_src_height;
+    auto const dst_size = m_dst_width * m_dst_height * 3U * sizeof(float);
+    if (src_buf->GetRawMemSize() < getBufferSize(width, height, m_src_fmt) ||
+        dst_buf->GetRawMemSize() < dst_size) {
+      return false;
+    }
+
+    auto src_frame = asAVFrame(src_buf, width, height, m_src_fmt);
+
+    YuvPlanes planes;
+    planes.y = src_frame->data[0];
+    planes.y_pitch = src_frame->linesize[0];
+    planes.u = src_frame->data[1];
+    planes.uv_pitch = src_frame->linesize[1];
+    if (AV_PIX_FMT_NV12 == m_src_fmt) {
+      planes.v = planes.u + 1;
+      planes.uv_step = 2;
+    } else {
+      planes.v = src_frame->data[2];
+      planes.uv_step = 1;
+    }
+
+    auto const coeffs = makeYuvToRgbCoeffs(BT_709 == cc_ctx.color_space,
+                                           JPEG == cc_ctx.color_range, m_mean,
+                                           m_std);
+    yuvToRgbPlanarF32(planes, dst_buf->GetDataAs<float>(), width, height,
+                      coeffs);
+    return true;
   }
 };
 }; // namespace VPF
 
 ConvertFrame::~ConvertFrame() { delete pImpl; }
 
-ConvertFrame::ConvertFrame(uint32_t width, uint32_t height,
-                           Pixel_Format src_fmt, Pixel_Format dst_fmt)
+ConvertFrame::ConvertFrame(uint32_t src_width, uint32_t src_height,
+                           uint32_t dst_width, uint32_t dst_height,
+                           Pixel_Format src_fmt, Pixel_Format dst_fmt,
+                           ScalingAlgorithm algorithm, uint32_t num_threads)
     : Task("FfmpegConvertFrame", ConvertFrame::numInputs,
            ConvertFrame::numOutputs) {
 
-  pImpl = new ConvertFrame_Impl(width, height, src_fmt, dst_fmt);
+  pImpl = new ConvertFrame_Impl(src_width, src_height, dst_width, dst_height,
+                                src_fmt, dst_fmt, algorithm, num_threads);
 }
 
 ConvertFrame* ConvertFrame::Make(uint32_t width, uint32_t height,
                                  Pixel_Format m_src_fmt,
                                  Pixel_Format m_dst_fmt) {
-  return new ConvertFrame(width, height, m_src_fmt, m_dst_fmt);
+  return new ConvertFrame(width, height, width, height, m_src_fmt, m_dst_fmt,
+                          ScalingAlgorithm::BILINEAR, 1U);
+}
+
+ConvertFrame* ConvertFrame::Make(uint32_t src_width, uint32_t src_height,
+                                 uint32_t dst_width, uint32_t dst_height,
+                                 Pixel_Format m_src_fmt, Pixel_Format m_dst_fmt,
+                                 ScalingAlgorithm algorithm,
+                                 uint32_t num_threads) {
+  return new ConvertFrame(src_width, src_height, dst_width, dst_height,
+                          m_src_fmt, m_dst_fmt, algorithm, num_threads);
+}
+
+void ConvertFrame::SetNormalization(const std::array<float, 3>& mean,
+                                    const std::array<float, 3>& std) {
+  if (!pImpl->m_use_kernel) {
+    throw std::invalid_argument(
+        "ConvertFrame: normalization is only supported for NV12 and YUV420 "
+        "to RGB_32F_PLANAR conversion without scaling");
+  }
+
+  for (auto const s : std) {
+    if (0.f == s) {
+      throw std::invalid_argument("ConvertFrame: std must not be zero");
+    }
+  }
+
+  pImpl->m_mean = mean;
+  pImpl->m_std = std;
 }
 
 TaskExecDetails ConvertFrame::Run() {
@@ -68,30 +343,51 @@ TaskExecDetails ConvertFrame::Run() {
                              TaskExecInfo::INVALID_INPUT, "empty cc_ctx");
     }
 
-    auto src_frame =
-        asAVFrame(src_buf, pImpl->m_width, pImpl->m_height, pImpl->m_src_fmt);
+    auto pCtx = ctx_buf->GetDataAs<ColorspaceConversionContext>();
 
-    auto dst_frame =
-        asAVFrame(dst_buf, pImpl->m_width, pImpl->m_height, pImpl->m_dst_fmt);
+    if (pImpl->m_use_kernel) {
+      if (!pImpl->RunKernel(src_buf, dst_buf, *pCtx)) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::INVALID_INPUT,
+                               "invalid buffer size");
+      }
 
-    auto pCtx = ctx_buf->GetDataAs<ColorspaceConversionContext>();
+      SetOutput(dst_buf, 0U);
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                             TaskExecInfo::SUCCESS);
+    }
+
+    auto src_frame = asAVFrame(src_buf, pImpl->m_src_width,
+                               pImpl->m_src_height, pImpl->m_src_fmt);
+
+    auto dst_frame = asAVFrame(dst_buf, pImpl->m_dst_width,
+                               pImpl->m_dst_height, pImpl->m_dst_fmt);
 
     auto const colorSpace = toFfmpegColorSpace(pCtx->color_space);
     auto const isJpegRange =
         (toFfmpegColorRange(pCtx->color_range) == AVCOL_RANGE_JPEG);
-    auto const brightness = 0U, contrast = 1U << 16U, saturation = 1U << 16U;
-    auto err = sws_setColorspaceDetails(
-        pImpl->m_ctx.get(), sws_getCoefficients(colorSpace), isJpegRange,
-        sws_getCoefficients(colorSpace), isJpegRange, brightness, contrast,
-        saturation);
-    if (err < 0) {
+    auto sws_ctx = pImpl->GetContext(colorSpace, isJpegRange);
+    if (!sws_ctx) {
       return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
                              TaskExecInfo::UNSUPPORTED_FMT_CONV_PARAMS,
                              "unsupported cconv params");
     }
 
-    err = sws_scale(pImpl->m_ctx.get(), src_frame->data, src_frame->linesize, 0,
-                    pImpl->m_height, dst_frame->data, dst_frame->linesize);
+    auto err = 0;
+    if (1U == pImpl->m_num_threads) {
+      err = sws_scale(sws_ctx, src_frame->data, src_frame->linesize, 0,
+                      pImpl->m_src_height, dst_frame->data,
+                      dst_frame->linesize);
+    } else {
+      /* Only frame API splits the frame into slices processed by libswscale
+       * worker threads.
+       */
+      refBuffer(*src_frame, *src_buf, pImpl->m_src_width, pImpl->m_src_height,
+                pImpl->m_src_fmt, AV_BUFFER_FLAG_READONLY);
+      refBuffer(*dst_frame, *dst_buf, pImpl->m_dst_width, pImpl->m_dst_height,
+                pImpl->m_dst_fmt, 0);
+      err = sws_scale_frame(sws_ctx, dst_frame.get(), src_frame.get());
+    }
     if (err < 0) {
       return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
                              TaskExecInfo::UNSUPPORTED_FMT_CONV_PARAMS,
@@ -13,11 +13,14 @@
 
 #include "CodecsSupport.hpp"
 #include "CudaUtils.hpp"
+#include "DecodeThreadBudget.hpp"
 #include "Tasks.hpp"
 #include "Utils.hpp"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -101,6 +104,23 @@ static std::string FindDecoderById(AVCodecID id) {
   return it->second;
 }
 
+/* Adds time spent within its scope to given stage stats.
+ */
+class StageTimer {
+  StageStats& m_stage;
+  std::chrono::steady_clock::time_point m_start;
+
+public:
+  explicit StageTimer(StageStats& stage)
+      : m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+
+  ~StageTimer() {
+    auto const elapsed = std::chrono::steady_clock::now() - m_start;
+    m_stage.Add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+};
+
 struct FfmpegDecodeFrame_Impl {
   std::shared_ptr<AVFormatContext> m_fmt_ctx;
   std::shared_ptr<SwrContext> m_swr_ctx;
@@ -112,7 +132,14 @@ struct FfmpegDecodeFrame_Impl {
   std::shared_ptr<AVDictionary> m_options;
   std::shared_ptr<TimeoutHandler> m_timeout_handler;
   std::shared_ptr<AVIOContext> m_io_ctx;
+  std::shared_ptr<PacketIndex> m_index;
   PacketData m_packet_data;
+
+  // Codec parameters given by user, only used by standalone decoder
+  StreamParams m_stream_params;
+
+  // Packets standalone decoder didn't accept yet
+  std::deque<std::shared_ptr<AVPacket>> m_pkt_queue;
   CUstream m_stream;
 
   // Video stream index
@@ -124,6 +151,12 @@ struct FfmpegDecodeFrame_Impl {
   // Last known height
   int m_last_h = -1;
 
+  // Last known pixel format, only tracked by standalone decoder
+  int m_last_fmt = AV_PIX_FMT_NONE;
+
+  // Cached stream parameters, rebuilt upon resolution change
+  std::shared_ptr<const MuxingParams> m_params;
+
   // Flag which signals that decode is done
   bool m_end_decode = false;
 
@@ -139,21 +172,46 @@ struct FfmpegDecodeFrame_Impl {
   // Flag which signals resolution change
   bool m_res_change = false;
 
-  /* These are handy counters for debug:
-   *
-   * Packets read.
-   * Packets sent.
-   * Frames received.
-   *
-   * Since incrementing them is negligible overhead, only output is put under
-   * conditional compilation. Change #if in class destructor to output values.
+  // Frames discard level set by user
+  AVDiscard m_skip_frame = AVDISCARD_DEFAULT;
+
+  // Decode mode set by user
+  DecodeMode m_mode = DecodeMode::FULL;
+
+  // Flag which signals that low delay options are applied
+  bool m_low_delay = false;
+
+  /* Seek target timestamp. Non-reference frames with smaller pts are
+   * discarded by decoder.
+   */
+  int64_t m_seek_pts = AV_NOPTS_VALUE;
+
+  /* Timestamp of the last key frame received from decoder and distance
+   * between two last consecutive key frames. Distance is kept across seek,
+   * timestamp is not because frames before and after seek aren't adjacent.
+   */
+  int64_t m_last_key_pts = AV_NOPTS_VALUE;
+  int64_t m_key_dist = AV_NOPTS_VALUE;
+
+  /* Number of frames index-less seek decodes forward instead of seeking if
+   * distance between key frames wasn't observed yet.
+   */
+  static constexpr int64_t decode_ahead_frames = 12;
+
+  /* Packets read, packets sent, frames received and time spent on every
+   * stage. Both incrementing counters and reading steady clock are negligible
+   * overhead compared to decoding.
    *
-   * Please note that seek heavy influences the difference between these
-   * counters values, that's ok.
+   * Please note that seek heavy influences the difference between packet
+   * and frame counters values, that's ok.
    */
-  uint32_t m_num_pkt_read = 0U;
-  uint32_t m_num_pkt_sent = 0U;
-  uint32_t m_num_frm_recv = 0U;
+  DecoderStats m_stats;
+
+  /* Weight and number of threads this decoder is registered with in
+   * process-wide thread budget. Zero if it's not registered.
+   */
+  int64_t m_budget_weight = 0;
+  uint32_t m_budget_threads = 0U;
 
   FfmpegDecodeFrame_Impl(
       const char* URL, const std::map<std::string, std::string>& ffmpeg_options,
@@ -190,24 +248,8 @@ struct FfmpegDecodeFrame_Impl {
       }
     }
 
-    // Set neccessary AVOptions for HW decoding.
-    auto options = GetAvOptions(ffmpeg_options);
-    if (stream) {
-      m_stream = stream.value();
-      auto res =
-          av_dict_set(&options, "hwaccel_device",
-                      std::to_string(GetDeviceIdByStream(m_stream)).c_str(), 0);
-      ThrowOnAvError(res, "Failed to set hwaccel_device AVOption", &options);
-
-      res = av_dict_set(&options, "current_ctx", "1", 0);
-      ThrowOnAvError(res, "Failed to set current_ctx AVOption", &options);
-    }
-
-    /* After we are done settings options, save them in case we need them
-     * later to (re)open codec;
-     */
-    m_options = std::shared_ptr<AVDictionary>(
-        options, [](void* p) { av_dict_free((AVDictionary**)&p); });
+    SetOptions(ffmpeg_options, stream);
+    auto options = m_options.get();
 
     // Set the timeout.
     m_timeout_handler.reset(new TimeoutHandler(&options, fmt_ctx));
@@ -257,7 +299,49 @@ struct FfmpegDecodeFrame_Impl {
     }
 
     OpenCodec(stream.has_value());
+    AllocFrameAndPacket();
+  }
+
+  /* Standalone decoder which has no input. Packets are given by user.
+   */
+  FfmpegDecodeFrame_Impl(
+      const StreamParams& params,
+      const std::map<std::string, std::string>& ffmpeg_options,
+      std::optional<CUstream> stream)
+      : m_stream_params(params) {
+    if (!m_stream_params.codec_params) {
+      throw std::invalid_argument("Empty codec parameters");
+    }
+
+    SetOptions(ffmpeg_options, stream);
+    m_stream_idx = 0;
+    m_last_fmt = m_stream_params.codec_params->format;
+    OpenCodec(stream.has_value());
+    AllocFrameAndPacket();
+  }
+
+  /* Sets neccessary AVOptions for HW decoding and saves them in case we need
+   * them later to (re)open codec;
+   */
+  void SetOptions(const std::map<std::string, std::string>& ffmpeg_options,
+                  std::optional<CUstream> stream) {
+    auto options = GetAvOptions(ffmpeg_options);
+    if (stream) {
+      m_stream = stream.value();
+      auto res =
+          av_dict_set(&options, "hwaccel_device",
+                      std::to_string(GetDeviceIdByStream(m_stream)).c_str(), 0);
+      ThrowOnAvError(res, "Failed to set hwaccel_device AVOption", &options);
 
+      res = av_dict_set(&options, "current_ctx", "1", 0);
+      ThrowOnAvError(res, "Failed to set current_ctx AVOption", &options);
+    }
+
+    m_options = std::shared_ptr<AVDictionary>(
+        options, [](void* p) { av_dict_free((AVDictionary**)&p); });
+  }
+
+  void AllocFrameAndPacket() {
     m_frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](void* p) {
       av_frame_unref((AVFrame*)p);
       av_frame_free((AVFrame**)&p);
@@ -269,6 +353,22 @@ struct FfmpegDecodeFrame_Impl {
     });
   }
 
+  // Standalone decoder has no input, packets are given by user.
+  bool IsStandalone() const { return !m_fmt_ctx; }
+
+  /* Returns parameters of video stream. They may change in the middle of the
+   * stream upon resolution change.
+   */
+  const AVCodecParameters* GetCodecPar() const {
+    return IsStandalone() ? m_stream_params.codec_params.get()
+                          : m_fmt_ctx->streams[GetVideoStrIdx()]->codecpar;
+  }
+
+  AVRational GetStreamTimeBase() const {
+    return IsStandalone() ? m_stream_params.time_base
+                          : m_fmt_ctx->streams[GetVideoStrIdx()]->time_base;
+  }
+
   // Saves current resolution
   void SaveCurrentRes() {
     m_last_h = GetHeight();
@@ -281,6 +381,7 @@ struct FfmpegDecodeFrame_Impl {
    * video codec.
    */
   void CloseCodec() {
+    ReleaseThreads();
     auto ret = avcodec_close(m_avc_ctx.get());
     if (ret < 0) {
       std::cerr << "Failed to close codec: " << AvErrorToString(ret);
@@ -296,27 +397,25 @@ struct FfmpegDecodeFrame_Impl {
    * video codec.
    */
   void OpenCodec(bool is_accelerated) {
-    auto video_stream = m_fmt_ctx->streams[GetVideoStrIdx()];
-    if (!video_stream) {
+    auto codecpar = GetCodecPar();
+    if (!codecpar) {
       std::stringstream ss;
       ss << "Could not find video stream in the input, aborting";
       throw std::runtime_error(ss.str());
     }
 
-    auto p_codec =
-        is_accelerated
-            ? avcodec_find_decoder_by_name(
-                  FindDecoderById(video_stream->codecpar->codec_id).c_str())
-            : avcodec_find_decoder(video_stream->codecpar->codec_id);
+    auto p_codec = is_accelerated
+                       ? avcodec_find_decoder_by_name(
+                             FindDecoderById(codecpar->codec_id).c_str())
+                       : avcodec_find_decoder(codecpar->codec_id);
 
     if (!p_codec && is_accelerated) {
-      throw std::runtime_error(
-          "Failed to find codec by name: " +
-          FindDecoderById(video_stream->codecpar->codec_id));
+      throw std::runtime_error("Failed to find codec by name: " +
+                               FindDecoderById(codecpar->codec_id));
     } else if (!p_codec) {
       throw std::runtime_error(
           "Failed to find codec by id: " +
-          std::string(avcodec_get_name(video_stream->codecpar->codec_id)));
+          std::string(avcodec_get_name(codecpar->codec_id)));
     }
 
     auto avctx = avcodec_alloc_context3(p_codec);
@@ -328,8 +427,7 @@ struct FfmpegDecodeFrame_Impl {
     m_avc_ctx = std::shared_ptr<AVCodecContext>(
         avctx, [](void* p) { avcodec_free_context((AVCodecContext**)&p); });
 
-    auto res =
-        avcodec_parameters_to_context(m_avc_ctx.get(), video_stream->codecpar);
+    auto res = avcodec_parameters_to_context(m_avc_ctx.get(), codecpar);
     if (res < 0) {
       std::stringstream ss;
       ss << "Failed to pass codec parameters to codec "
@@ -387,16 +485,65 @@ struct FfmpegDecodeFrame_Impl {
      * discarded. Without that, libavcodec won't be able to reconstruct
      * correct PTS values.
      */
-    m_avc_ctx->pkt_timebase = m_fmt_ctx->streams[GetVideoStrIdx()]->time_base;
+    m_avc_ctx->pkt_timebase = GetStreamTimeBase();
+
+    // HW decoder doesn't use CPU threads.
+    if (!is_accelerated) {
+      AcquireThreads(&options);
+    }
 
     res = avcodec_open2(m_avc_ctx.get(), p_codec, &options);
     if (options) {
       av_dict_free(&options);
     }
 
+    if (res < 0) {
+      ReleaseThreads();
+    }
+
     ThrowOnAvError(
         res, "Failed to open codec " +
                  std::string(av_get_media_type_string(AVMEDIA_TYPE_VIDEO)));
+
+    // May be set with AVOptions.
+    m_skip_frame = m_avc_ctx->skip_frame;
+  }
+
+  /* Takes number of threads from process-wide budget unless it's set by user.
+   * Zero threads means one thread per core for libavcodec, so it's subject to
+   * budget as well.
+   */
+  void AcquireThreads(AVDictionary** options) {
+    auto entry = av_dict_get(*options, "threads", nullptr, 0);
+    if (entry && std::string("0") != entry->value &&
+        std::string("auto") != entry->value) {
+      return;
+    }
+
+    auto codecpar = GetCodecPar();
+    m_budget_weight =
+        std::max((int64_t)codecpar->width * codecpar->height, (int64_t)1);
+
+    auto const num_threads =
+        DecodeThreadBudget::Instance().Acquire(m_budget_weight);
+    m_budget_threads = num_threads;
+    if (num_threads) {
+      auto const value = std::to_string(num_threads);
+      auto res = av_dict_set(options, "threads", value.c_str(), 0);
+      if (res < 0) {
+        ReleaseThreads();
+      }
+      ThrowOnAvError(res, "Failed to set threads AVOption", options);
+    }
+  }
+
+  void ReleaseThreads() {
+    if (m_budget_weight) {
+      DecodeThreadBudget::Instance().Release(m_budget_weight,
+                                             m_budget_threads);
+      m_budget_weight = 0;
+      m_budget_threads = 0U;
+    }
   }
 
   void SavePacketData() {
@@ -412,7 +559,10 @@ struct FfmpegDecodeFrame_Impl {
     }
   }
 
-  TaskExecDetails DecodeSingleFrame(Token& dst) {
+  /* Decodes single frame and copies it to dst.
+   * If dst is nullptr, frame is decoded but not copied.
+   */
+  TaskExecDetails DecodeSingleFrame(Token* dst) {
     if (m_end_decode) {
       return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
                              "decode finished");
@@ -432,7 +582,11 @@ struct FfmpegDecodeFrame_Impl {
         }
 
         m_timeout_handler->Reset();
-        auto ret = av_read_frame(m_fmt_ctx.get(), m_pkt.get());
+        auto ret = 0;
+        {
+          StageTimer timer(m_stats.demux);
+          ret = av_read_frame(m_fmt_ctx.get(), m_pkt.get());
+        }
 
         if (AVERROR_EOF == ret) {
           m_eof = true;
@@ -442,9 +596,14 @@ struct FfmpegDecodeFrame_Impl {
           return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
                                  TaskExecInfo::FAIL, AvErrorToString(ret));
         } else {
-          m_num_pkt_read++;
+          m_stats.num_pkt_read++;
+          m_stats.bytes_read += m_pkt->size;
         }
-      } while (m_pkt->stream_index != GetVideoStrIdx());
+      } while (IsPacketDropped());
+
+      if (!m_eof) {
+        SetSkipFrame(m_pkt->pts);
+      }
 
       auto status = DecodeSinglePacket(m_eof ? nullptr : m_pkt.get(), dst);
 
@@ -476,6 +635,130 @@ struct FfmpegDecodeFrame_Impl {
                            TaskExecInfo::SUCCESS);
   }
 
+  /* Queues given packet, sends queued packets to decoder and receives single
+   * frame. Pass nullptr packet to flush decoder. Only used by standalone
+   * decoder.
+   *
+   * Frame stashed upon resolution change is returned by the next call before
+   * anything is sent to decoder. Packet given to that call is queued, call
+   * without packet doesn't start the flush.
+   */
+  TaskExecDetails DecodeStandalone(Token& dst, const Buffer* pkt_buf,
+                                   const PacketData* pkt_data) {
+    if (m_end_decode) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             "decode finished");
+    }
+
+    if (pkt_buf && m_eof) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::INVALID_INPUT,
+                             "decoder is being flushed");
+    }
+
+    if (pkt_buf) {
+      auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](void* p) {
+        av_packet_unref((AVPacket*)p);
+        av_packet_free((AVPacket**)&p);
+      });
+
+      // Packet is copied because libavcodec requires padding.
+      auto res = av_new_packet(pkt.get(), pkt_buf->GetRawMemSize());
+      if (res < 0) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(res));
+      }
+      memcpy(pkt->data, pkt_buf->GetRawMemPtr(), pkt_buf->GetRawMemSize());
+
+      if (pkt_data) {
+        pkt->pts = pkt_data->pts;
+        pkt->dts = pkt_data->dts;
+        pkt->duration = pkt_data->duration;
+        pkt->flags |= pkt_data->key ? AV_PKT_FLAG_KEY : 0;
+      }
+      m_pkt_queue.push_back(pkt);
+      m_stats.num_pkt_read++;
+      m_stats.bytes_read += pkt->size;
+    } else if (!m_res_change) {
+      m_eof = true;
+    }
+
+    if (m_res_change) {
+      m_res_change = false;
+      if (DEC_SUCCESS != OutputLastFrame(dst)) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL,
+                               "decoder error upon resolution change");
+      }
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                             TaskExecInfo::SUCCESS);
+    }
+
+    // Decoder may not accept packets until frames are received from it.
+    while (!m_pkt_queue.empty()) {
+      auto res = 0;
+      {
+        StageTimer timer(m_stats.send);
+        res = avcodec_send_packet(m_avc_ctx.get(), m_pkt_queue.front().get());
+      }
+      if (AVERROR(EAGAIN) == res) {
+        break;
+      } else if (res < 0) {
+        m_end_decode = true;
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(res));
+      }
+      m_stats.num_pkt_sent++;
+      m_pkt_queue.pop_front();
+    }
+
+    // Repeated flush request is harmless, decoder just returns EOF.
+    if (m_eof && m_pkt_queue.empty()) {
+      avcodec_send_packet(m_avc_ctx.get(), nullptr);
+    }
+
+    SaveCurrentRes();
+    auto res = 0;
+    {
+      StageTimer timer(m_stats.receive);
+      res = avcodec_receive_frame(m_avc_ctx.get(), m_frame.get());
+    }
+    if (AVERROR_EOF == res) {
+      m_end_decode = true;
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::END_OF_STREAM, "end of stream");
+    } else if (AVERROR(EAGAIN) == res) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::MORE_DATA_NEEDED,
+                             "more packets needed");
+    } else if (res < 0) {
+      m_end_decode = true;
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             AvErrorToString(res));
+    }
+    m_stats.num_frm_recv++;
+
+    /* Pixel format may not be known until first frame is decoded, so its
+     * change is signaled same way as resolution change.
+     */
+    auto const fmt_change = (m_last_fmt != m_frame->format);
+    m_last_fmt = m_frame->format;
+    if (UpdGetResChange() || fmt_change) {
+      m_res_change = true;
+      m_params.reset();
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                             TaskExecInfo::RES_CHANGE, "resolution change");
+    }
+
+    if (DEC_SUCCESS != OutputLastFrame(dst)) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             "failed to output decoded frame");
+    }
+
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+
   void SaveMotionVectors() {
     AVFrameSideData* sd =
         av_frame_get_side_data(m_frame.get(), AV_FRAME_DATA_MOTION_VECTORS);
@@ -500,7 +783,16 @@ struct FfmpegDecodeFrame_Impl {
     return true;
   }
 
+  /* Returns 0 if pixel format isn't known yet. It happens to standalone
+   * decoder before first frame is decoded.
+   */
   uint32_t GetHostFrameSize() const {
+    auto const codec_fmt =
+        IsAccelerated() ? m_avc_ctx->sw_pix_fmt : m_avc_ctx->pix_fmt;
+    if (AV_PIX_FMT_NONE == codec_fmt) {
+      return 0U;
+    }
+
     const auto format = toFfmpegPixelFormat(GetPixelFormat());
     const auto alignment = 1;
     const auto size =
@@ -539,6 +831,13 @@ struct FfmpegDecodeFrame_Impl {
 
   bool UpdGetResChange() {
     m_res_change = (m_last_h != GetHeight()) || (m_last_w != GetWidth());
+
+    /* Some parameters, e. g. HW decoder pixel format, are only known after
+     * first frame is decoded, so cache is also dropped then.
+     */
+    if (m_res_change || 1U == m_stats.num_frm_recv) {
+      m_params.reset();
+    }
     return m_res_change;
   }
 
@@ -549,9 +848,25 @@ struct FfmpegDecodeFrame_Impl {
 
   /* Copy last decoded frame to output token.
    * It doesn't check if memory amount is sufficient.
+   * HostFrame token is not copied to but references the decoded frame.
    */
   DECODE_STATUS GetLastFrame(Token& dst) {
-    if (m_frame->hw_frames_ctx) {
+    StageTimer timer(m_stats.copy);
+    auto p_host_frame = dynamic_cast<HostFrame*>(&dst);
+    if (p_host_frame) {
+      // Only reference decoded frame, no memcpy.
+      if (m_frame->hw_frames_ctx) {
+        std::cerr << "Can't reference frame in CUDA memory as HostFrame";
+        return DEC_ERROR;
+      }
+
+      try {
+        p_host_frame->Update(m_frame.get());
+      } catch (std::exception& e) {
+        std::cerr << "Error while referencing a frame: " << e.what();
+        return DEC_ERROR;
+      }
+    } else if (m_frame->hw_frames_ctx) {
       // Codec has HW acceleration and outputs to CUDA memory
       try {
         CopyToSurface(*m_frame.get(), dynamic_cast<Surface&>(dst));
@@ -580,10 +895,81 @@ struct FfmpegDecodeFrame_Impl {
     return DEC_SUCCESS;
   }
 
+  /* Returns true if last read packet shall not be sent to decoder.
+   * Dropped video packets are unreferenced here.
+   */
+  bool IsPacketDropped() {
+    if (m_pkt->stream_index != GetVideoStrIdx()) {
+      return true;
+    }
+
+    if (DecodeMode::KEY_FRAMES == m_mode && !(m_pkt->flags & AV_PKT_FLAG_KEY)) {
+      av_packet_unref(m_pkt.get());
+      return true;
+    }
+
+    return false;
+  }
+
+  /* Returns discard level which takes decode mode into account.
+   */
+  AVDiscard GetSkipFrame() const {
+    return DecodeMode::KEY_FRAMES == m_mode
+               ? std::max(m_skip_frame, AVDISCARD_NONKEY)
+               : m_skip_frame;
+  }
+
+  /* Discards non-reference frames which precede seek target. Nothing
+   * refers to them and they won't be output, so there's no point in
+   * reconstructing them.
+   */
+  void SetSkipFrame(int64_t pkt_pts) {
+    auto const is_before_target = AV_NOPTS_VALUE != m_seek_pts &&
+                                  AV_NOPTS_VALUE != pkt_pts &&
+                                  pkt_pts < m_seek_pts;
+
+    m_avc_ctx->skip_frame = is_before_target
+                                ? std::max(GetSkipFrame(), AVDISCARD_NONREF)
+                                : GetSkipFrame();
+  }
+
+  /* Measures distance between consecutive key frames received from decoder.
+   */
+  void UpdateKeyDist() {
+    if (!(m_frame->flags & AV_FRAME_FLAG_KEY) ||
+        AV_NOPTS_VALUE == m_frame->pts) {
+      return;
+    }
+
+    if (AV_NOPTS_VALUE != m_last_key_pts && m_frame->pts > m_last_key_pts) {
+      m_key_dist = m_frame->pts - m_last_key_pts;
+    }
+    m_last_key_pts = m_frame->pts;
+  }
+
+  /* Saves side data and packet data of last decoded frame and copies it to
+   * output token.
+   */
+  DECODE_STATUS OutputLastFrame(Token& dst) {
+    SaveSideData();
+    SavePacketData();
+    return GetLastFrame(dst);
+  }
+
+  /* Same as above but does nothing if dst is nullptr.
+   */
+  DECODE_STATUS OutputLastFrame(Token* dst) {
+    if (!dst) {
+      return DEC_SUCCESS;
+    }
+
+    return OutputLastFrame(*dst);
+  }
+
   /* Decodes single video frame.
    *
    * Upon successful decoder copies decoded frame to dst token and returns
-   * DEC_SUCCESS.
+   * DEC_SUCCESS. If dst is nullptr, nothing is copied.
    *
    * Upon resolution change doesn't copy decoded frame to dst token and
    * returns DEC_RES_CHANGE.
@@ -594,12 +980,15 @@ struct FfmpegDecodeFrame_Impl {
    *
    * Upont error returns DEC_ERROR.
    */
-  DECODE_STATUS DecodeSinglePacket(AVPacket* pkt, Token& dst) {
+  DECODE_STATUS DecodeSinglePacket(AVPacket* pkt, Token* dst) {
     SaveCurrentRes();
     int res = 0;
 
     if (!m_flush) {
-      res = avcodec_send_packet(m_avc_ctx.get(), pkt);
+      {
+        StageTimer timer(m_stats.send);
+        res = avcodec_send_packet(m_avc_ctx.get(), pkt);
+      }
       if (AVERROR_EOF == res) {
         // Flush decoder;
         res = 0;
@@ -611,14 +1000,17 @@ struct FfmpegDecodeFrame_Impl {
         std::cerr << "Error description: " << AvErrorToString(res);
         return DEC_ERROR;
       } else {
-        m_num_pkt_sent++;
+        m_stats.num_pkt_sent++;
         if (pkt) {
           av_packet_unref(pkt);
         }
       }
     }
 
-    res = avcodec_receive_frame(m_avc_ctx.get(), m_frame.get());
+    {
+      StageTimer timer(m_stats.receive);
+      res = avcodec_receive_frame(m_avc_ctx.get(), m_frame.get());
+    }
     if (res == AVERROR_EOF) {
       return DEC_EOS;
     } else if (res == AVERROR(EAGAIN)) {
@@ -632,25 +1024,32 @@ struct FfmpegDecodeFrame_Impl {
       std::cerr << "Error description: " << AvErrorToString(res);
       return DEC_ERROR;
     } else {
-      m_num_frm_recv++;
+      m_stats.num_frm_recv++;
+      UpdateKeyDist();
     }
 
     if (UpdGetResChange()) {
       return DEC_RES_CHANGE;
     }
 
-    SaveSideData();
-    SavePacketData();
-    return GetLastFrame(dst);
+    return OutputLastFrame(dst);
+  }
+
+  DecoderStats GetStats() const {
+    auto stats = m_stats;
+    stats.num_threads = m_avc_ctx ? m_avc_ctx->thread_count : 0;
+
+    // AVIO counts container overhead and other streams as well.
+    auto const pb = IsStandalone() ? nullptr : m_fmt_ctx->pb;
+    if (pb) {
+      stats.bytes_read = pb->bytes_read;
+    }
+
+    return stats;
   }
 
   ~FfmpegDecodeFrame_Impl() {
-// For debug purposes
-#if 0
-    std::cout << "m_num_pkt_read: " << m_num_pkt_read << std::endl;
-    std::cout << "m_num_pkt_sent: " << m_num_pkt_sent << std::endl;
-    std::cout << "m_num_frm_recv: " << m_num_frm_recv << std::endl;
-#endif
+    ReleaseThreads();
 
     for (auto& output : m_side_data) {
       if (output.second) {
@@ -663,19 +1062,25 @@ struct FfmpegDecodeFrame_Impl {
   int GetVideoStrIdx() const { return m_stream_idx; }
 
   double GetFrameRate() const {
+    // Standalone decoder only knows what bitstream signals.
+    if (IsStandalone()) {
+      return av_q2d(m_avc_ctx->framerate);
+    }
+
     return (double)m_fmt_ctx->streams[GetVideoStrIdx()]->r_frame_rate.num /
            (double)m_fmt_ctx->streams[GetVideoStrIdx()]->r_frame_rate.den;
   }
 
   double GetAvgFrameRate() const {
+    if (IsStandalone()) {
+      return av_q2d(m_avc_ctx->framerate);
+    }
+
     return (double)m_fmt_ctx->streams[GetVideoStrIdx()]->avg_frame_rate.num /
            (double)m_fmt_ctx->streams[GetVideoStrIdx()]->avg_frame_rate.den;
   }
 
-  double GetTimeBase() const {
-    return (double)m_fmt_ctx->streams[GetVideoStrIdx()]->time_base.num /
-           (double)m_fmt_ctx->streams[GetVideoStrIdx()]->time_base.den;
-  }
+  double GetTimeBase() const { return av_q2d(GetStreamTimeBase()); }
 
   int GetWidth() const {
     if (m_frame && m_frame->width > 0) {
@@ -696,13 +1101,22 @@ struct FfmpegDecodeFrame_Impl {
   AVCodecID GetCodecId() const { return m_avc_ctx->codec_id; }
 
   int64_t GetNumFrames() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->nb_frames;
+    // Index is precise while container may not know the number of frames.
+    if (m_index) {
+      return m_index->Size();
+    }
+
+    return IsStandalone() ? 0
+                          : m_fmt_ctx->streams[GetVideoStrIdx()]->nb_frames;
   }
 
-  int64_t GetStartTime() const { return m_fmt_ctx->start_time; }
+  int64_t GetStartTime() const {
+    return IsStandalone() ? 0 : m_fmt_ctx->start_time;
+  }
 
   int64_t GetStreamStartTime() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->start_time;
+    return IsStandalone() ? 0
+                          : m_fmt_ctx->streams[GetVideoStrIdx()]->start_time;
   }
 
   double GetStartTimeS() const {
@@ -710,25 +1124,25 @@ struct FfmpegDecodeFrame_Impl {
   }
 
   double GetDuration() const {
+    if (IsStandalone()) {
+      return 0.0;
+    }
+
     return double(m_fmt_ctx->streams[GetVideoStrIdx()]->duration) /
            double(AV_TIME_BASE);
   }
 
-  int64_t GetBitRate() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->codecpar->bit_rate;
-  }
+  int64_t GetBitRate() const { return GetCodecPar()->bit_rate; }
 
-  int64_t GetProfile() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->codecpar->profile;
-  }
+  int64_t GetProfile() const { return GetCodecPar()->profile; }
 
-  int64_t GetLevel() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->codecpar->level;
-  }
+  int64_t GetLevel() const { return GetCodecPar()->level; }
 
   int64_t GetDelay() const { return m_avc_ctx->delay; }
 
-  int64_t GetNumStreams() const { return m_fmt_ctx->nb_streams; }
+  int64_t GetNumStreams() const {
+    return IsStandalone() ? 1 : m_fmt_ctx->nb_streams;
+  }
 
   int64_t GetGopSize() const { return m_avc_ctx->gop_size; }
 
@@ -741,6 +1155,8 @@ struct FfmpegDecodeFrame_Impl {
     std::stringstream err_msg;
 
     switch (format) {
+    case AV_PIX_FMT_NONE:
+      return UNDEFINED;
     case AV_PIX_FMT_NV12:
       return NV12;
     case AV_PIX_FMT_YUVJ420P:
@@ -770,16 +1186,15 @@ struct FfmpegDecodeFrame_Impl {
     }
   }
 
-  AVColorSpace GetColorSpace() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->codecpar->color_space;
-  }
+  AVColorSpace GetColorSpace() const { return GetCodecPar()->color_space; }
 
-  AVColorRange GetColorRange() const {
-    return m_fmt_ctx->streams[GetVideoStrIdx()]->codecpar->color_range;
-  }
+  AVColorRange GetColorRange() const { return GetCodecPar()->color_range; }
 
   std::map<std::string, std::string> GetMetaData() const {
     std::map<std::string, std::string> tags;
+    if (IsStandalone()) {
+      return tags;
+    }
 
     const auto dict = m_fmt_ctx->metadata;
     auto tag = av_dict_iterate(dict, nullptr);
@@ -794,6 +1209,52 @@ struct FfmpegDecodeFrame_Impl {
 
   bool IsVFR() const { return GetFrameRate() != GetAvgFrameRate(); }
 
+  // Collects stream parameters. Metadata is copied, so it's not cheap.
+  std::shared_ptr<const MuxingParams> MakeParams() const {
+    auto p_params = std::make_shared<MuxingParams>();
+    auto& params = *p_params;
+
+    params.videoContext.width = GetWidth();
+    params.videoContext.height = GetHeight();
+    params.videoContext.profile = GetProfile();
+    params.videoContext.level = GetLevel();
+    params.videoContext.delay = GetDelay();
+    params.videoContext.gop_size = GetGopSize();
+    params.videoContext.num_frames = GetNumFrames();
+    params.videoContext.is_vfr = IsVFR();
+    params.videoContext.num_streams = GetNumStreams();
+    params.videoContext.duration = GetDuration();
+    params.videoContext.stream_index = GetStreamIndex();
+    params.videoContext.host_frame_size = GetHostFrameSize();
+    params.videoContext.bit_rate = GetBitRate();
+
+    params.videoContext.frame_rate = GetFrameRate();
+    params.videoContext.avg_frame_rate = GetAvgFrameRate();
+    params.videoContext.time_base = GetTimeBase();
+    params.videoContext.start_time = GetStartTimeS();
+
+    params.videoContext.format = GetPixelFormat();
+
+    params.videoContext.color_range = fromFfmpegColorRange(GetColorRange());
+
+    switch (GetColorSpace()) {
+    case AVCOL_SPC_BT709:
+      params.videoContext.color_space = BT_709;
+      break;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+      params.videoContext.color_space = BT_601;
+      break;
+    default:
+      params.videoContext.color_space = UNSPEC;
+      break;
+    }
+
+    params.videoContext.metadata = GetMetaData();
+
+    return p_params;
+  }
+
   bool IsAccelerated() const { return m_avc_ctx->hw_frames_ctx != nullptr; }
 
   int64_t TsFromTime(double ts_sec) {
@@ -805,8 +1266,7 @@ struct FfmpegDecodeFrame_Impl {
 
     // Rescale the timestamp to value represented in stream time base units;
     AVRational factor = {1, AV_TIME_BASE};
-    return av_rescale_q(ts_tbu, factor,
-                        m_fmt_ctx->streams[GetVideoStrIdx()]->time_base);
+    return av_rescale_q(ts_tbu, factor, GetStreamTimeBase());
   }
 
   int64_t TsFromFrameNumber(int64_t frame_num) {
@@ -814,22 +1274,249 @@ struct FfmpegDecodeFrame_Impl {
     return TsFromTime(ts_sec);
   }
 
-  TaskExecDetails SeekDecode(Token& dst, const SeekContext& ctx) {
-    /* If custom AVIOContext was used, have to check the seek support.
-     * May not be enabled.
+  /* Checks if opened codec parameters still match stream parameters.
+   * They don't after resolution change in the middle of the stream.
+   */
+  bool IsCodecUpToDate() const {
+    auto const par = GetCodecPar();
+    if (m_avc_ctx->width != par->width || m_avc_ctx->height != par->height) {
+      return false;
+    }
+
+    // HW decoder output format is never the same as stream format.
+    if (!m_avc_ctx->hw_device_ctx && par->format != AV_PIX_FMT_NONE &&
+        m_avc_ctx->pix_fmt != par->format) {
+      return false;
+    }
+
+    return true;
+  }
+
+  /* Frame threading delays output by number of threads, so only slice
+   * threading is left. Low delay flag isn't set for streams with B-frames,
+   * decoder would output them out of order. Options are saved, so they
+   * survive codec reopen.
+   *
+   * Codec is reopened, reference frames are lost, so it's only done before
+   * the first packet is sent to decoder.
+   */
+  void SetLowDelay() {
+    if (m_low_delay) {
+      return;
+    }
+
+    if (m_stats.num_pkt_sent) {
+      throw std::runtime_error(
+          "Low delay can only be set before decoding starts");
+    }
+
+    if (!IsStandalone()) {
+      m_fmt_ctx->flags |= AVFMT_FLAG_NOBUFFER;
+    }
+
+    AVDictionary* options = nullptr;
+    auto res = av_dict_copy(&options, m_options.get(), 0);
+    ThrowOnAvError(res, "Can't copy AVOptions", options ? &options : nullptr);
+
+    // Appended to flags set by user, if any.
+    if (!GetCodecPar()->video_delay) {
+      res = av_dict_set(&options, "flags", "+low_delay", AV_DICT_APPEND);
+      ThrowOnAvError(res, "Failed to set flags AVOption", &options);
+    }
+
+    res = av_dict_set(&options, "thread_type", "slice", 0);
+    ThrowOnAvError(res, "Failed to set thread_type AVOption", &options);
+
+    m_options = std::shared_ptr<AVDictionary>(
+        options, [](void* p) { av_dict_free((AVDictionary**)&p); });
+
+    auto const was_accelerated = IsAccelerated();
+    CloseCodec();
+    OpenCodec(was_accelerated);
+    m_params.reset();
+    m_low_delay = true;
+  }
+
+  /* Resets decoder state before seek.
+   *
+   * Flushing the codec is enough to start decoding from another key frame and
+   * it's much cheaper than reopening: codec context, extradata, HW device
+   * context and frame threads are all kept. Codec is only reopened if its
+   * parameters no longer match the stream.
+   */
+  void ResetCodec() {
+    if (IsCodecUpToDate()) {
+      avcodec_flush_buffers(m_avc_ctx.get());
+    } else {
+      auto const was_accelerated = IsAccelerated();
+      CloseCodec();
+      OpenCodec(was_accelerated);
+      m_params.reset();
+      m_stats.num_codec_reopen++;
+    }
+
+    /* Discard pending packet, existing frame timestamp and EOF flag.
+     * Otherwise, seek will only go forward and will return EOF if seek is
+     * done when decoder has previously get all available packets.
      */
+    av_packet_unref(m_pkt.get());
+    m_frame->pts = AV_NOPTS_VALUE;
+    m_last_key_pts = AV_NOPTS_VALUE;
+    m_eof = false;
+    m_flush = false;
+    m_resend = false;
+    m_end_decode = false;
+  }
+
+  /* If custom AVIOContext was used, have to check the seek support.
+   * May not be enabled.
+   */
+  bool IsSeekable() const {
+    if (IsStandalone()) {
+      return false;
+    }
+
     if (m_fmt_ctx->flags & AVFMT_FLAG_CUSTOM_IO) {
-      if (!m_fmt_ctx->pb->seek) {
-        return TaskExecDetails(
-            TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::NOT_SUPPORTED,
-            "Seek operation is not supported by AVIOContext.");
+      return m_fmt_ctx->pb->seek != nullptr;
+    }
+
+    return true;
+  }
+
+  /* Seeks to the beginning of the stream and resets decoder state.
+   */
+  TaskExecDetails Rewind() {
+    auto start_time = GetStreamStartTime();
+    if (AV_NOPTS_VALUE == start_time) {
+      start_time = 0;
+    }
+
+    m_timeout_handler->Reset();
+    auto ret = avformat_seek_file(m_fmt_ctx.get(), GetVideoStrIdx(), INT64_MIN,
+                                  start_time, start_time, 0);
+    if (ret < 0) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             AvErrorToString(ret));
+    }
+
+    ResetCodec();
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+
+  TaskExecDetails BuildIndex() {
+    if (!IsSeekable()) {
+      return TaskExecDetails(
+          TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::NOT_SUPPORTED,
+          "Seek operation is not supported by AVIOContext.");
+    }
+
+    auto details = Rewind();
+    if (details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS) {
+      return details;
+    }
+
+    auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](void* p) {
+      av_packet_unref((AVPacket*)p);
+      av_packet_free((AVPacket**)&p);
+    });
+
+    std::vector<PacketIndexEntry> entries;
+    if (GetNumFrames() > 0) {
+      entries.reserve(GetNumFrames());
+    }
+
+    while (true) {
+      m_timeout_handler->Reset();
+      auto ret = av_read_frame(m_fmt_ctx.get(), pkt.get());
+      if (AVERROR_EOF == ret) {
+        break;
+      } else if (ret < 0) {
+        details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                                  TaskExecInfo::FAIL, AvErrorToString(ret));
+        break;
+      }
+
+      /* Packets marked for discard are decoded but never output, so they
+       * don't count as frames.
+       */
+      if (pkt->stream_index != GetVideoStrIdx() ||
+          (pkt->flags & AV_PKT_FLAG_DISCARD)) {
+        av_packet_unref(pkt.get());
+        continue;
+      }
+
+      if (AV_NOPTS_VALUE == pkt->pts) {
+        details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                                  TaskExecInfo::NOT_SUPPORTED,
+                                  "Can't index packets without pts");
+        break;
+      }
+
+      PacketIndexEntry entry = {};
+      entry.pts = pkt->pts;
+      entry.dts = pkt->dts;
+      entry.pos = pkt->pos;
+      entry.size = pkt->size;
+      entry.key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+      entries.push_back(entry);
+
+      av_packet_unref(pkt.get());
+    }
+
+    // Demuxer has reached the end, start over.
+    auto rewind_details = Rewind();
+    if (details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS) {
+      return details;
+    } else if (rewind_details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS) {
+      return rewind_details;
+    }
+
+    auto const time_base = GetStreamTimeBase();
+    m_index.reset(PacketIndex::Make(std::move(entries), GetVideoStrIdx(),
+                                    time_base.num, time_base.den));
+    m_params.reset();
+
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+
+  void SetIndex(std::shared_ptr<PacketIndex> index) {
+    if (index) {
+      auto const time_base = GetStreamTimeBase();
+      if (index->StreamIndex() != GetVideoStrIdx() ||
+          index->TimeBaseNum() != time_base.num ||
+          index->TimeBaseDen() != time_base.den) {
+        throw std::invalid_argument("Packet index doesn't match the input");
       }
     }
 
+    m_index = index;
+    m_params.reset();
+  }
+
+  /* Checks if frame with given pts will be output by decoder without seek.
+   */
+  bool IsAheadOfLastFrame(int64_t pts) const {
+    return !m_end_decode && AV_NOPTS_VALUE != m_frame->pts &&
+           m_frame->pts < pts;
+  }
+
+  TaskExecDetails SeekDecode(Token& dst, const SeekContext& ctx) {
+    if (!IsSeekable()) {
+      return TaskExecDetails(
+          TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::NOT_SUPPORTED,
+          "Seek operation is not supported by AVIOContext.");
+    }
+
     /* Across this function packet presentation timestamp (PTS) values are
      * used to compare given timestamp against. That's done so because ffmpeg
      * seek relies on PTS.
      */
+    if (m_index) {
+      return SeekDecodeIndexed(dst, ctx);
+    }
+
     if (IsVFR() && ctx.IsByNumber()) {
       return TaskExecDetails(
           TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::NOT_SUPPORTED,
@@ -841,9 +1528,9 @@ struct FfmpegDecodeFrame_Impl {
      * convert to timestamp. BTW that's the reason seek by frame number is not
      * supported for VFR videos.
      *
-     * Also we always seek backwards to nearest previous key frame and then
-     * decode in the loop starting from it until we reach a frame with
-     * desired timestamp. Sic !
+     * Also we seek backwards to nearest previous key frame and then decode
+     * in the loop starting from it until we reach a frame with desired
+     * timestamp. Sic ! The only exception is target which is close ahead.
      */
     auto timestamp = ctx.IsByNumber() ? TsFromFrameNumber(ctx.seek_frame)
                                       : TsFromTime(ctx.seek_tssec);
@@ -860,35 +1547,118 @@ struct FfmpegDecodeFrame_Impl {
       start_time = 0;
     }
 
-    auto const was_accelerated = IsAccelerated();
-    CloseCodec();
-    OpenCodec(was_accelerated);
+    /* Position of the next key frame is unknown without index. If target is
+     * less than key frame distance ahead of the last decoded frame, decoding
+     * forward takes no more frames than decoding from the preceding key
+     * frame. Until the distance is observed, fixed window is used instead.
+     */
+    auto const target_pts = timestamp - start_time;
+    auto const max_dist = AV_NOPTS_VALUE != m_key_dist
+                              ? m_key_dist
+                              : TsFromFrameNumber(decode_ahead_frames);
+    auto const decode_forward = IsAheadOfLastFrame(target_pts) &&
+                                target_pts - m_frame->pts < max_dist;
+
+    if (!decode_forward) {
+      StageTimer timer(m_stats.seek);
+      m_timeout_handler->Reset();
+      auto ret =
+          avformat_seek_file(m_fmt_ctx.get(), GetVideoStrIdx(), 0, timestamp,
+                             timestamp, AVSEEK_FLAG_BACKWARD);
+
+      if (ret < 0) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(ret));
+      }
+      ResetCodec();
+    }
 
-    m_timeout_handler->Reset();
-    auto ret = avformat_seek_file(m_fmt_ctx.get(), GetVideoStrIdx(), 0,
-                                  timestamp, timestamp, AVSEEK_FLAG_BACKWARD);
+    return DecodeUntil(target_pts, dst);
+  }
 
-    if (ret < 0) {
-      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
-                             AvErrorToString(ret));
-    } else {
-      avcodec_flush_buffers(m_avc_ctx.get());
+  /* Index knows exact timestamps of every frame, so both frame number and
+   * timestamp are converted to index entry. Seek is done to the closest
+   * preceding key frame, then decoding goes on until the entry is reached.
+   * Unlike index-less seek, it works for VFR sequences as well.
+   */
+  TaskExecDetails SeekDecodeIndexed(Token& dst, const SeekContext& ctx) {
+    auto start_time = GetStreamStartTime();
+    if (AV_NOPTS_VALUE == start_time) {
+      start_time = 0;
     }
 
-    /* Discard existing frame timestamp and OEF flag.
-     * Otherwise, seek will only go forward and will return EOF if seek is
-     * done when decoder has previously get all available packets.
-     */
-    m_frame->pts = AV_NOPTS_VALUE;
-    m_eof = false;
+    auto const frame_num =
+        ctx.IsByNumber()
+            ? static_cast<size_t>(ctx.seek_frame)
+            : m_index->FrameNumber(TsFromTime(ctx.seek_tssec) + start_time);
+
+    if (frame_num >= m_index->Size()) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::END_OF_STREAM,
+                             "seek beyond the end of stream");
+    }
+
+    auto const& entry = m_index->At(frame_num);
+    auto const key_pts = m_index->At(entry.key_num).pts;
 
-    /* Decode in loop until we reach desired frame.
+    /* No key frame between the last decoded frame and target, so decoding
+     * forward is cheaper than going back to the same key frame again.
      */
-    while (m_frame->pts + start_time < timestamp) {
-      auto details = DecodeSingleFrame(dst);
+    auto const decode_forward =
+        IsAheadOfLastFrame(entry.pts) &&
+        entry.key_num <= (int64_t)m_index->FrameNumber(m_frame->pts);
+
+    if (!decode_forward) {
+      StageTimer timer(m_stats.seek);
+      m_timeout_handler->Reset();
+      auto ret = avformat_seek_file(m_fmt_ctx.get(), GetVideoStrIdx(),
+                                    INT64_MIN, key_pts, key_pts, 0);
+      if (ret < 0) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(ret));
+      }
+      ResetCodec();
+    }
+
+    return DecodeUntil(entry.pts, dst);
+  }
+
+  /* Decodes in loop until frame with pts not less than given one is reached
+   * and copies it to dst. Preceding frames aren't copied and non-reference
+   * ones aren't even reconstructed.
+   */
+  TaskExecDetails DecodeUntil(int64_t target_pts, Token& dst) {
+    TaskExecDetails details(TaskExecStatus::TASK_EXEC_SUCCESS,
+                            TaskExecInfo::SUCCESS);
+    auto res_change = false;
+
+    m_seek_pts = target_pts;
+    while (m_frame->pts < target_pts) {
+      details = DecodeSingleFrame(nullptr);
       if (details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS) {
-        return details;
+        break;
       }
+      res_change |= (TaskExecInfo::RES_CHANGE == details.m_info);
+    }
+    m_seek_pts = AV_NOPTS_VALUE;
+    m_avc_ctx->skip_frame = GetSkipFrame();
+
+    if (details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS) {
+      return details;
+    }
+
+    /* Target frame doesn't fit dst any more. Stash it, same way as
+     * DecodeFrame::Run does, so that it's returned upon next call.
+     */
+    if (res_change) {
+      m_res_change = true;
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                             TaskExecInfo::RES_CHANGE, "resolution change");
+    }
+
+    if (DEC_SUCCESS != OutputLastFrame(dst)) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             "failed to output seek target frame");
     }
 
     return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
@@ -912,6 +1682,21 @@ TaskExecDetails DecodeFrame::Run() {
     return pImpl->SeekDecode(*dst, *seek_ctx);
   }
 
+  auto pkt_buf = static_cast<Buffer*>(GetInput(2U));
+  if (pkt_buf && !pImpl->IsStandalone()) {
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                           TaskExecInfo::INVALID_INPUT,
+                           "packets can only be given to standalone decoder");
+  }
+
+  // Standalone decoder returns stashed frame by itself.
+  if (pImpl->IsStandalone()) {
+    auto pkt_data_buf = static_cast<Buffer*>(GetInput(3U));
+    auto pkt_data =
+        pkt_data_buf ? pkt_data_buf->GetDataAs<PacketData>() : nullptr;
+    return pImpl->DecodeStandalone(*dst, pkt_buf, pkt_data);
+  }
+
   /* In case of resolution change decoder will reconstruct a frame but will not
    * return it to user because of inplace API. Amount of given memory
    * may be insufficient.
@@ -920,7 +1705,7 @@ TaskExecDetails DecodeFrame::Run() {
    * Next decode call will return stashed frame.
    */
   if (pImpl->FlipGetResChange()) {
-    if (DEC_SUCCESS == pImpl->GetLastFrame(*dst)) {
+    if (DEC_SUCCESS == pImpl->OutputLastFrame(*dst)) {
       return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
                              TaskExecInfo::SUCCESS);
     }
@@ -928,7 +1713,7 @@ TaskExecDetails DecodeFrame::Run() {
                            "decoder error upon resolution change");
   }
 
-  return pImpl->DecodeSingleFrame(*dst);
+  return pImpl->DecodeSingleFrame(dst);
 }
 
 uint32_t DecodeFrame::GetHostFrameSize() const {
@@ -936,46 +1721,16 @@ uint32_t DecodeFrame::GetHostFrameSize() const {
 }
 
 void DecodeFrame::GetParams(MuxingParams& params) {
-  params = MuxingParams();
-
-  params.videoContext.width = pImpl->GetWidth();
-  params.videoContext.height = pImpl->GetHeight();
-  params.videoContext.profile = pImpl->GetProfile();
-  params.videoContext.level = pImpl->GetLevel();
-  params.videoContext.delay = pImpl->GetDelay();
-  params.videoContext.gop_size = pImpl->GetGopSize();
-  params.videoContext.num_frames = pImpl->GetNumFrames();
-  params.videoContext.is_vfr = pImpl->IsVFR();
-  params.videoContext.num_streams = pImpl->GetNumStreams();
-  params.videoContext.duration = pImpl->GetDuration();
-  params.videoContext.stream_index = pImpl->GetStreamIndex();
-  params.videoContext.host_frame_size = pImpl->GetHostFrameSize();
-  params.videoContext.bit_rate = pImpl->GetBitRate();
-
-  params.videoContext.frame_rate = pImpl->GetFrameRate();
-  params.videoContext.avg_frame_rate = pImpl->GetAvgFrameRate();
-  params.videoContext.time_base = pImpl->GetTimeBase();
-  params.videoContext.start_time = pImpl->GetStartTimeS();
-
-  params.videoContext.format = pImpl->GetPixelFormat();
-
-  params.videoContext.color_range =
-      fromFfmpegColorRange(pImpl->GetColorRange());
-
-  switch (pImpl->GetColorSpace()) {
-  case AVCOL_SPC_BT709:
-    params.videoContext.color_space = BT_709;
-    break;
-  case AVCOL_SPC_BT470BG:
-  case AVCOL_SPC_SMPTE170M:
-    params.videoContext.color_space = BT_601;
-    break;
-  default:
-    params.videoContext.color_space = UNSPEC;
-    break;
-  }
-
-  params.videoContext.metadata = pImpl->GetMetaData();
+  params = *GetParamsSnapshot();
+}
+
+DecoderStats DecodeFrame::GetStats() const { return pImpl->GetStats(); }
+
+std::shared_ptr<const MuxingParams> DecodeFrame::GetParamsSnapshot() {
+  if (!pImpl->m_params) {
+    pImpl->m_params = pImpl->MakeParams();
+  }
+  return pImpl->m_params;
 }
 
 TaskExecDetails DecodeFrame::GetSideData(AVFrameSideDataType data_type) {
@@ -1010,12 +1765,46 @@ DecodeFrame::DecodeFrame(const char* URL, NvDecoderClInterface& cli_iface,
   pImpl = new FfmpegDecodeFrame_Impl(URL, ffmpeg_options, stream, p_io_ctx);
 }
 
+DecodeFrame* DecodeFrame::Make(const StreamParams& params,
+                               NvDecoderClInterface& cli_iface,
+                               std::optional<CUstream> stream) {
+  return new DecodeFrame(params, cli_iface, stream);
+}
+
+DecodeFrame::DecodeFrame(const StreamParams& params,
+                         NvDecoderClInterface& cli_iface,
+                         std::optional<CUstream> stream)
+    : Task("DecodeFrame", DecodeFrame::num_inputs, DecodeFrame::num_outputs) {
+  std::map<std::string, std::string> ffmpeg_options;
+  cli_iface.GetOptions(ffmpeg_options);
+
+  pImpl = new FfmpegDecodeFrame_Impl(params, ffmpeg_options, stream);
+}
+
 DecodeFrame::~DecodeFrame() { delete pImpl; }
 
 bool DecodeFrame::IsAccelerated() const { return pImpl->IsAccelerated(); }
 
 bool DecodeFrame::IsVFR() const { return pImpl->IsVFR(); }
 
+bool DecodeFrame::IsStandalone() const { return pImpl->IsStandalone(); }
+
 const PacketData& DecodeFrame::GetLastPacketData() const {
   return pImpl->m_packet_data;
 }
+
+TaskExecDetails DecodeFrame::BuildIndex() { return pImpl->BuildIndex(); }
+
+void DecodeFrame::SetIndex(std::shared_ptr<PacketIndex> index) {
+  pImpl->SetIndex(index);
+}
+
+std::shared_ptr<PacketIndex> DecodeFrame::GetIndex() const {
+  return pImpl->m_index;
+}
+
+void DecodeFrame::SetMode(DecodeMode mode) { pImpl->m_mode = mode; }
+
+DecodeMode DecodeFrame::GetMode() const { return pImpl->m_mode; }
+
+void DecodeFrame::SetLowDelay() { pImpl->SetLowDelay(); }
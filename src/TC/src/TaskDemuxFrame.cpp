@@ -0,0 +1,298 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CodecsSupport.hpp"
+#include "Tasks.hpp"
+#include "Utils.hpp"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+using namespace VPF;
+
+namespace VPF {
+
+StreamParams StreamParams::Make(const AVCodecParameters* codec_params,
+                                AVRational time_base) {
+  StreamParams params;
+  params.time_base = time_base;
+  params.codec_params = std::shared_ptr<AVCodecParameters>(
+      avcodec_parameters_alloc(),
+      [](void* p) { avcodec_parameters_free((AVCodecParameters**)&p); });
+
+  if (!params.codec_params) {
+    throw std::runtime_error("Failed to allocate codec parameters");
+  }
+
+  auto res = avcodec_parameters_copy(params.codec_params.get(), codec_params);
+  ThrowOnAvError(res, "Failed to copy codec parameters");
+
+  return params;
+}
+
+StreamParams StreamParams::Make(const std::string& codec, int width,
+                                int height,
+                                const std::vector<uint8_t>& extradata,
+                                AVRational time_base) {
+  auto p_codec = avcodec_find_decoder_by_name(codec.c_str());
+  auto desc = p_codec ? avcodec_descriptor_get(p_codec->id)
+                      : avcodec_descriptor_get_by_name(codec.c_str());
+  if (!desc || AVMEDIA_TYPE_VIDEO != desc->type) {
+    throw std::invalid_argument("Unknown video codec: " + codec);
+  }
+
+  StreamParams params;
+  params.time_base = time_base;
+  params.codec_params = std::shared_ptr<AVCodecParameters>(
+      avcodec_parameters_alloc(),
+      [](void* p) { avcodec_parameters_free((AVCodecParameters**)&p); });
+
+  if (!params.codec_params) {
+    throw std::runtime_error("Failed to allocate codec parameters");
+  }
+
+  auto par = params.codec_params.get();
+  par->codec_type = AVMEDIA_TYPE_VIDEO;
+  par->codec_id = desc->id;
+  par->width = width;
+  par->height = height;
+
+  if (!extradata.empty()) {
+    // Codec parameters own extradata, it must be padded.
+    par->extradata = static_cast<uint8_t*>(
+        av_mallocz(extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!par->extradata) {
+      throw std::runtime_error("Failed to allocate extradata");
+    }
+    memcpy(par->extradata, extradata.data(), extradata.size());
+    par->extradata_size = extradata.size();
+  }
+
+  return params;
+}
+
+struct DemuxFrame_Impl {
+  std::shared_ptr<AVFormatContext> m_fmt_ctx;
+  std::shared_ptr<AVPacket> m_pkt;
+  std::shared_ptr<TimeoutHandler> m_timeout_handler;
+  std::shared_ptr<AVIOContext> m_io_ctx;
+  StreamParams m_stream_params;
+  PacketData m_packet_data = {};
+
+  // Video stream index
+  int m_stream_idx = -1;
+
+  // Flag which signals end of file
+  bool m_eof = false;
+
+  DemuxFrame_Impl(const char* URL,
+                  const std::map<std::string, std::string>& ffmpeg_options,
+                  std::shared_ptr<AVIOContext> p_io_ctx)
+      : m_io_ctx(p_io_ctx) {
+
+    // Allocate format context first to set timeout before opening the input.
+    AVFormatContext* fmt_ctx = avformat_alloc_context();
+    if (!fmt_ctx) {
+      throw std::runtime_error("Failed to allocate format context");
+    }
+
+    // Same as decoder does, determine input format by hand for custom IO.
+    if (m_io_ctx) {
+      fmt_ctx->pb = m_io_ctx.get();
+      fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+      if (fmt_ctx->pb->seek) {
+        std::array<uint8_t, 1024U> probe;
+        auto nbytes = fmt_ctx->pb->read_packet(fmt_ctx->pb->opaque,
+                                               probe.data(), probe.size());
+        fmt_ctx->pb->seek(fmt_ctx->pb->opaque, 0U, SEEK_SET);
+
+        AVProbeData probe_data = {};
+        probe_data.buf = probe.data();
+        probe_data.buf_size = nbytes;
+        probe_data.filename = "";
+
+        fmt_ctx->iformat = av_probe_input_format(&probe_data, 1);
+      }
+    }
+
+    auto options = GetAvOptions(ffmpeg_options);
+    m_timeout_handler.reset(new TimeoutHandler(&options, fmt_ctx));
+
+    m_timeout_handler->Reset();
+    auto res =
+        avformat_open_input(&fmt_ctx, m_io_ctx ? "" : URL, NULL, &options);
+    if (options) {
+      av_dict_free(&options);
+    }
+    ThrowOnAvError(res, "Can't open souce file " + std::string(URL));
+
+    m_fmt_ctx = std::shared_ptr<AVFormatContext>(
+        fmt_ctx, [](void* p) { avformat_close_input((AVFormatContext**)&p); });
+
+    m_timeout_handler->Reset();
+    res = avformat_find_stream_info(m_fmt_ctx.get(), NULL);
+    ThrowOnAvError(res, "Can't find stream information");
+
+    m_stream_idx = av_find_best_stream(m_fmt_ctx.get(), AVMEDIA_TYPE_VIDEO, -1,
+                                       -1, NULL, 0);
+    if (m_stream_idx < 0) {
+      std::stringstream ss;
+      ss << "Could not find " << av_get_media_type_string(AVMEDIA_TYPE_VIDEO)
+         << " stream in file " << URL;
+      ss << "Error description: " << AvErrorToString(m_stream_idx);
+      throw std::runtime_error(ss.str());
+    }
+
+    auto video_stream = m_fmt_ctx->streams[m_stream_idx];
+    m_stream_params =
+        StreamParams::Make(video_stream->codecpar, video_stream->time_base);
+
+    m_pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](void* p) {
+      av_packet_unref((AVPacket*)p);
+      av_packet_free((AVPacket**)&p);
+    });
+  }
+
+  TaskExecDetails DemuxSinglePacket() {
+    if (m_eof) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::END_OF_STREAM, "end of stream");
+    }
+
+    do {
+      av_packet_unref(m_pkt.get());
+
+      m_timeout_handler->Reset();
+      auto ret = av_read_frame(m_fmt_ctx.get(), m_pkt.get());
+
+      if (AVERROR_EOF == ret) {
+        m_eof = true;
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::END_OF_STREAM, "end of stream");
+      } else if (ret < 0) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(ret));
+      }
+    } while (m_pkt->stream_index != m_stream_idx);
+
+    // Packet data must be refcounted to be shared without copy.
+    auto ret = av_packet_make_refcounted(m_pkt.get());
+    if (ret < 0) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             AvErrorToString(ret));
+    }
+
+    m_packet_data = {};
+    m_packet_data.key = (m_pkt->flags & AV_PKT_FLAG_KEY) != 0;
+    m_packet_data.pts = m_pkt->pts;
+    m_packet_data.dts = m_pkt->dts;
+    m_packet_data.pos = m_pkt->pos;
+    m_packet_data.bsl = m_pkt->size;
+    m_packet_data.duration = m_pkt->duration;
+
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+
+  TaskExecDetails Seek(int64_t timestamp) {
+    m_timeout_handler->Reset();
+    auto ret = av_seek_frame(m_fmt_ctx.get(), m_stream_idx, timestamp,
+                             AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             AvErrorToString(ret));
+    }
+
+    av_packet_unref(m_pkt.get());
+    m_packet_data = {};
+    m_eof = false;
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+
+  std::shared_ptr<AVPacket> GetLastPacket() const {
+    auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](void* p) {
+      av_packet_unref((AVPacket*)p);
+      av_packet_free((AVPacket**)&p);
+    });
+
+    if (!pkt) {
+      throw std::runtime_error("Failed to allocate packet");
+    }
+
+    auto res = av_packet_ref(pkt.get(), m_pkt.get());
+    ThrowOnAvError(res, "Failed to reference packet");
+
+    return pkt;
+  }
+};
+} // namespace VPF
+
+TaskExecDetails DemuxFrame::Run() {
+  ClearOutputs();
+  return pImpl->DemuxSinglePacket();
+}
+
+DemuxFrame* DemuxFrame::Make(const char* URL, NvDecoderClInterface& cli_iface,
+                             std::shared_ptr<AVIOContext> p_io_ctx) {
+  return new DemuxFrame(URL, cli_iface, p_io_ctx);
+}
+
+DemuxFrame::DemuxFrame(const char* URL, NvDecoderClInterface& cli_iface,
+                       std::shared_ptr<AVIOContext> p_io_ctx)
+    : Task("DemuxFrame", DemuxFrame::num_inputs, DemuxFrame::num_outputs) {
+  std::map<std::string, std::string> ffmpeg_options;
+  cli_iface.GetOptions(ffmpeg_options);
+
+  pImpl = new DemuxFrame_Impl(URL, ffmpeg_options, p_io_ctx);
+}
+
+DemuxFrame::~DemuxFrame() { delete pImpl; }
+
+std::shared_ptr<AVPacket> DemuxFrame::GetLastPacket() const {
+  return pImpl->GetLastPacket();
+}
+
+const PacketData& DemuxFrame::GetLastPacketData() const {
+  return pImpl->m_packet_data;
+}
+
+TaskExecDetails DemuxFrame::Seek(int64_t timestamp) {
+  return pImpl->Seek(timestamp);
+}
+
+const StreamParams& DemuxFrame::GetStreamParams() const {
+  return pImpl->m_stream_params;
+}
+
+int DemuxFrame::GetStreamIndex() const { return pImpl->m_stream_idx; }
+
+int DemuxFrame::GetNumStreams() const {
+  return pImpl->m_fmt_ctx->nb_streams;
+}
+
+int64_t DemuxFrame::GetStreamStartTime() const {
+  auto const start_time =
+      pImpl->m_fmt_ctx->streams[pImpl->m_stream_idx]->start_time;
+  return AV_NOPTS_VALUE != start_time ? start_time : 0;
+}
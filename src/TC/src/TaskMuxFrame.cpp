@@ -0,0 +1,290 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CodecsSupport.hpp"
+#include "Tasks.hpp"
+#include "Utils.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+using namespace VPF;
+
+namespace VPF {
+
+struct MuxFrame_Impl {
+  std::shared_ptr<AVFormatContext> m_fmt_ctx;
+
+  // Output video stream, owned by format context
+  AVStream* m_stream = nullptr;
+
+  // Time base of incoming packets timestamps
+  AVRational m_time_base = {0, 1};
+
+  // Flag which signals that trailer was written
+  bool m_flushed = false;
+
+  /* Async mode. Packets are queued and written by background thread.
+   * Queue is bounded, so slow output blocks the producer instead of eating up
+   * all the memory.
+   */
+  static constexpr size_t m_max_queue_size = 64U;
+  std::deque<std::shared_ptr<AVPacket>> m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
+  bool m_stop = false;
+  bool m_async = false;
+
+  // First write error, sticky
+  int m_error = 0;
+
+  MuxFrame_Impl(const char* URL, const StreamParams& params,
+                const std::map<std::string, std::string>& ffmpeg_options,
+                const std::string& format, bool async)
+      : m_time_base(params.time_base), m_async(async) {
+    if (!params.codec_params) {
+      throw std::invalid_argument("Empty codec parameters");
+    }
+
+    AVFormatContext* fmt_ctx = nullptr;
+    auto res = avformat_alloc_output_context2(
+        &fmt_ctx, nullptr, format.empty() ? nullptr : format.c_str(), URL);
+    ThrowOnAvError(res, "Can't allocate output context for " +
+                            std::string(URL));
+
+    m_fmt_ctx = std::shared_ptr<AVFormatContext>(fmt_ctx, [](void* p) {
+      auto ctx = (AVFormatContext*)p;
+      if (!(ctx->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep(&ctx->pb);
+      }
+      avformat_free_context(ctx);
+    });
+
+    m_stream = avformat_new_stream(m_fmt_ctx.get(), nullptr);
+    if (!m_stream) {
+      throw std::runtime_error("Failed to allocate output stream");
+    }
+
+    res = avcodec_parameters_copy(m_stream->codecpar,
+                                  params.codec_params.get());
+    ThrowOnAvError(res, "Failed to copy codec parameters");
+
+    // Codec tag is container-specific, let muxer choose it.
+    m_stream->codecpar->codec_tag = 0;
+    m_stream->time_base = m_time_base;
+
+    /* Same options dictionary is given to IO context and muxer, each of them
+     * takes the options it understands.
+     */
+    auto options = GetAvOptions(ffmpeg_options);
+    if (!(m_fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+      res = avio_open2(&m_fmt_ctx->pb, URL, AVIO_FLAG_WRITE, nullptr,
+                       &options);
+      ThrowOnAvError(res, "Can't open output file " + std::string(URL),
+                     &options);
+    }
+
+    res = avformat_write_header(m_fmt_ctx.get(), &options);
+    ThrowOnAvError(res, "Failed to write container header", &options);
+    if (options) {
+      av_dict_free(&options);
+    }
+
+    if (m_async) {
+      m_thread = std::thread(&MuxFrame_Impl::Run, this);
+    }
+  }
+
+  ~MuxFrame_Impl() { Stop(); }
+
+  // Background thread loop
+  void Run() {
+    while (true) {
+      std::shared_ptr<AVPacket> pkt;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+          return;
+        }
+        pkt = m_queue.front();
+        m_queue.pop_front();
+      }
+      m_cv.notify_all();
+
+      // Packets are dropped after first error, nothing good can be written.
+      auto const res = m_error ? 0 : WritePacket(pkt.get());
+      if (res < 0) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_error = res;
+      }
+    }
+  }
+
+  // Waits for background thread to write all queued packets.
+  void Stop() {
+    if (!m_thread.joinable()) {
+      return;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+  }
+
+  int WritePacket(AVPacket* pkt) {
+    av_packet_rescale_ts(pkt, m_time_base, m_stream->time_base);
+    return av_interleaved_write_frame(m_fmt_ctx.get(), pkt);
+  }
+
+  TaskExecDetails MuxSinglePacket(const Buffer& pkt_buf,
+                                  const PacketData* pkt_data) {
+    if (m_flushed) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::FAIL, "muxer was flushed");
+    }
+
+    auto pkt = std::shared_ptr<AVPacket>(av_packet_alloc(), [](void* p) {
+      av_packet_unref((AVPacket*)p);
+      av_packet_free((AVPacket**)&p);
+    });
+
+    // Packet is copied because it may outlive given buffer in async mode.
+    auto res = av_new_packet(pkt.get(), pkt_buf.GetRawMemSize());
+    if (res < 0) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             AvErrorToString(res));
+    }
+    memcpy(pkt->data, pkt_buf.GetRawMemPtr(), pkt_buf.GetRawMemSize());
+
+    pkt->stream_index = m_stream->index;
+    if (pkt_data) {
+      pkt->pts = pkt_data->pts;
+      pkt->dts = pkt_data->dts;
+      pkt->duration = pkt_data->duration;
+      pkt->flags |= pkt_data->key ? AV_PKT_FLAG_KEY : 0;
+    }
+
+    if (!m_async) {
+      res = WritePacket(pkt.get());
+      if (res < 0) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(res));
+      }
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                             TaskExecInfo::SUCCESS);
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&] {
+        return m_error || m_queue.size() < m_max_queue_size;
+      });
+
+      if (m_error) {
+        return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                               TaskExecInfo::FAIL, AvErrorToString(m_error));
+      }
+      m_queue.push_back(pkt);
+    }
+    m_cv.notify_all();
+
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+
+  TaskExecDetails Flush() {
+    if (m_flushed) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                             TaskExecInfo::SUCCESS);
+    }
+
+    Stop();
+    m_flushed = true;
+
+    // Trailer is written anyway to leave the output in consistent state.
+    auto res = av_write_trailer(m_fmt_ctx.get());
+    if (!m_error && res < 0) {
+      m_error = res;
+    }
+
+    if (!(m_fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+      res = avio_closep(&m_fmt_ctx->pb);
+      if (!m_error && res < 0) {
+        m_error = res;
+      }
+    }
+
+    if (m_error) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL, TaskExecInfo::FAIL,
+                             AvErrorToString(m_error));
+    }
+
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_SUCCESS,
+                           TaskExecInfo::SUCCESS);
+  }
+};
+} // namespace VPF
+
+TaskExecDetails MuxFrame::Run() {
+  auto pkt_buf = static_cast<Buffer*>(GetInput(0U));
+  if (!pkt_buf) {
+    return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                           TaskExecInfo::INVALID_INPUT, "empty packet");
+  }
+
+  auto pkt_data_buf = static_cast<Buffer*>(GetInput(1U));
+  auto pkt_data =
+      pkt_data_buf ? pkt_data_buf->GetDataAs<PacketData>() : nullptr;
+  return pImpl->MuxSinglePacket(*pkt_buf, pkt_data);
+}
+
+TaskExecDetails MuxFrame::Flush() { return pImpl->Flush(); }
+
+bool MuxFrame::IsAsync() const { return pImpl->m_async; }
+
+MuxFrame* MuxFrame::Make(const char* URL, const StreamParams& params,
+                         NvDecoderClInterface& cli_iface,
+                         const std::string& format, bool async) {
+  return new MuxFrame(URL, params, cli_iface, format, async);
+}
+
+MuxFrame::MuxFrame(const char* URL, const StreamParams& params,
+                   NvDecoderClInterface& cli_iface, const std::string& format,
+                   bool async)
+    : Task("MuxFrame", MuxFrame::num_inputs, MuxFrame::num_outputs) {
+  std::map<std::string, std::string> ffmpeg_options;
+  cli_iface.GetOptions(ffmpeg_options);
+
+  pImpl = new MuxFrame_Impl(URL, params, ffmpeg_options, format, async);
+}
+
+MuxFrame::~MuxFrame() {
+  pImpl->Flush();
+  delete pImpl;
+}
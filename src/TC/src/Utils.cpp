@@ -1,4 +1,5 @@
 #include "Utils.hpp"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -90,6 +91,13 @@ std::shared_ptr<AVFrame> makeAVFrame(int width, int height, int format) {
   return frame;
 }
 
+/* VALI planar RGB formats store R, G and B planes one after another while
+ * libavutil planar RGB formats have G, B and R planes.
+ */
+static bool isPlanarRgb(AVPixelFormat format) {
+  return AV_PIX_FMT_GBRP == format || AV_PIX_FMT_GBRPF32LE == format;
+}
+
 std::shared_ptr<AVFrame> asAVFrame(Buffer* pBuf, int width, int height,
                                    AVPixelFormat format) {
   std::shared_ptr<AVFrame> frame(av_frame_alloc(),
@@ -103,6 +111,11 @@ std::shared_ptr<AVFrame> asAVFrame(Buffer* pBuf, int width, int height,
     throw std::runtime_error("meaningful message");
   }
 
+  if (isPlanarRgb(format)) {
+    std::rotate(frame->data, frame->data + 1, frame->data + 3);
+    std::rotate(frame->linesize, frame->linesize + 1, frame->linesize + 3);
+  }
+
   return frame;
 }
 
@@ -112,8 +125,17 @@ std::shared_ptr<Buffer> makeBufferFromAVFrame(std::shared_ptr<AVFrame> src) {
                                       (AVPixelFormat)src->format, alignment);
   auto pBuf = std::shared_ptr<Buffer>(Buffer::MakeOwnMem(out_size));
 
+  uint8_t* data[AV_NUM_DATA_POINTERS];
+  int linesize[AV_NUM_DATA_POINTERS];
+  std::copy(src->data, src->data + AV_NUM_DATA_POINTERS, data);
+  std::copy(src->linesize, src->linesize + AV_NUM_DATA_POINTERS, linesize);
+  if (isPlanarRgb((AVPixelFormat)src->format)) {
+    std::rotate(data, data + 2, data + 3);
+    std::rotate(linesize, linesize + 2, linesize + 3);
+  }
+
   auto ret = av_image_copy_to_buffer(
-      pBuf->GetDataAs<uint8_t>(), out_size, src->data, src->linesize,
+      pBuf->GetDataAs<uint8_t>(), out_size, data, linesize,
       (AVPixelFormat)src->format, src->width, src->height, alignment);
   if (ret < 0) {
     throw std::runtime_error("meaningful message");
@@ -139,11 +161,11 @@ static const std::vector<std::pair<Pixel_Format, AVPixelFormat>>
              {RGB, AV_PIX_FMT_RGB24},
              {NV12, AV_PIX_FMT_NV12},
              {YUV420, AV_PIX_FMT_YUV420P},
-             {RGB_PLANAR, AV_PIX_FMT_NONE},
+             {RGB_PLANAR, AV_PIX_FMT_GBRP},
              {BGR, AV_PIX_FMT_BGR24},
              {YUV444, AV_PIX_FMT_YUV444P},
              {RGB_32F, AV_PIX_FMT_RGBF32LE},
-             {RGB_32F_PLANAR, AV_PIX_FMT_NONE},
+             {RGB_32F_PLANAR, AV_PIX_FMT_GBRPF32LE},
              {YUV422, AV_PIX_FMT_YUV422P},
              {P10, AV_PIX_FMT_P010},
              {P12, AV_PIX_FMT_YUV420P12},
@@ -2,8 +2,11 @@ import numpy
 from _typeshed import Incomplete
 from typing import ClassVar, overload
 
+AREA: ScalingAlgorithm
 ASYNC_ENCODE_SUPPORT: NV_ENC_CAPS
 BGR: PixelFormat
+BICUBIC: ScalingAlgorithm
+BILINEAR: ScalingAlgorithm
 BIT_DEPTH_NOT_SUPPORTED: TaskExecInfo
 BT_601: ColorSpace
 BT_709: ColorSpace
@@ -13,18 +16,21 @@ END_OF_STREAM: TaskExecInfo
 ERROR: FfmpegLogLevel
 EXPOSED_COUNT: NV_ENC_CAPS
 FAIL: TaskExecInfo
+FAST_BILINEAR: ScalingAlgorithm
 FATAL: FfmpegLogLevel
 HEIGHT_MAX: NV_ENC_CAPS
 HEIGHT_MIN: NV_ENC_CAPS
 INFO: FfmpegLogLevel
 INVALID_INPUT: TaskExecInfo
 JPEG: ColorRange
+LANCZOS: ScalingAlgorithm
 LEVEL_MAX: NV_ENC_CAPS
 LEVEL_MIN: NV_ENC_CAPS
 MB_NUM_MAX: NV_ENC_CAPS
 MB_PER_SEC_MAX: NV_ENC_CAPS
 MORE_DATA_NEEDED: TaskExecInfo
 MPEG: ColorRange
+NEAREST: ScalingAlgorithm
 NOT_SUPPORTED: TaskExecInfo
 NO_PTS: int
 NUM_MAX_BFRAMES: NV_ENC_CAPS
@@ -41,6 +47,7 @@ RGB_32F: PixelFormat
 RGB_32F_PLANAR: PixelFormat
 RGB_PLANAR: PixelFormat
 SEPARATE_COLOUR_PLANE: NV_ENC_CAPS
+SPLINE: ScalingAlgorithm
 SRC_DST_SIZE_MISMATCH: TaskExecInfo
 SUCCESS: TaskExecInfo
 SUPPORTED_RATECONTROL_MODES: NV_ENC_CAPS
@@ -160,6 +167,47 @@ class CudaStreamEvent:
     def __init__(self, *args, **kwargs) -> None: ...
     def Wait(self) -> None: ...
 
+class DecodeMode:
+    __members__: ClassVar[dict] = ...  # read-only
+    FULL: ClassVar[DecodeMode] = ...
+    KEY_FRAMES: ClassVar[DecodeMode] = ...
+    __entries: ClassVar[dict] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
+class DecoderStats:
+    def __init__(self, *args, **kwargs) -> None: ...
+    @property
+    def bytes_read(self) -> int: ...
+    @property
+    def copy(self) -> StageStats: ...
+    @property
+    def demux(self) -> StageStats: ...
+    @property
+    def num_codec_reopen(self) -> int: ...
+    @property
+    def num_frm_recv(self) -> int: ...
+    @property
+    def num_pkt_read(self) -> int: ...
+    @property
+    def num_pkt_sent(self) -> int: ...
+    @property
+    def num_threads(self) -> int: ...
+    @property
+    def receive(self) -> StageStats: ...
+    @property
+    def seek(self) -> StageStats: ...
+    @property
+    def send(self) -> StageStats: ...
+
 class DLDeviceType:
     __members__: ClassVar[dict] = ...  # read-only
     __entries: ClassVar[dict] = ...
@@ -199,6 +247,38 @@ class FfmpegLogLevel:
     @property
     def value(self) -> int: ...
 
+class HostFrame:
+    def __init__(self) -> None: ...
+    def Plane(self, plane: int = ...) -> HostFramePlane: ...
+    @property
+    def Empty(self) -> bool: ...
+    @property
+    def Format(self) -> PixelFormat: ...
+    @property
+    def Height(self) -> int: ...
+    @property
+    def HostSize(self) -> int: ...
+    @property
+    def NumPlanes(self) -> int: ...
+    @property
+    def Planes(self) -> list[HostFramePlane]: ...
+    @property
+    def Width(self) -> int: ...
+
+class HostFramePlane:
+    def __init__(self, *args, **kwargs) -> None: ...
+    def __buffer__(self, flags): ...
+    def __dlpack__(self, stream: int = ...) -> capsule: ...
+    def __dlpack_device__(self) -> tuple[DLDeviceType, int]: ...
+    @property
+    def ElemSize(self) -> int: ...
+    @property
+    def Height(self) -> int: ...
+    @property
+    def Pitch(self) -> int: ...
+    @property
+    def Width(self) -> int: ...
+
 class MotionVector:
     dst_x: int
     dst_y: int
@@ -319,19 +399,45 @@ class PixelFormat:
     @property
     def value(self) -> int: ...
 
+class PyClipCutter:
+    def __init__(self, input: str, opts: dict[str, str], mux_opts: dict[str, str] = ...) -> None: ...
+    def Cut(self, ranges: list[tuple[float, float]], outputs: list[str], format: str = ..., snap_backward: bool = ...) -> list[tuple[bool, TaskExecInfo]]: ...
+
 class PyDecoder:
+    @overload
+    def __init__(self, buffer: bytes | memoryview | numpy.ndarray, opts: dict[str, str], gpu_id: int = ...) -> None: ...
     @overload
     def __init__(self, input: str, opts: dict[str, str], gpu_id: int = ...) -> None: ...
     @overload
-    def __init__(self, buffered_reader: object, opts: dict[str, str], gpu_id: int = ...) -> None: ...
+    def __init__(self, params: StreamParams, opts: dict[str, str], gpu_id: int = ...) -> None: ...
+    @overload
+    def __init__(self, fd: int, opts: dict[str, str], gpu_id: int = ...) -> None: ...
+    @overload
+    def __init__(self, buffered_reader: object, opts: dict[str, str], gpu_id: int = ..., read_ahead: int = ...) -> None: ...
+    def BuildIndex(self, path: str = ...) -> None: ...
+    def DecodeBatch(self, num_frames: int, frames: numpy.ndarray, pkt_info: numpy.ndarray) -> tuple[int, TaskExecInfo]: ...
+    def DecodeFrames(self, frame_nums: list[int], frames: numpy.ndarray, pkt_info: numpy.ndarray) -> tuple[bool, TaskExecInfo]: ...
+    @overload
+    def DecodePacket(self, frame: numpy.ndarray, packet: numpy.ndarray | None, pts: int | None = ...) -> tuple[bool, TaskExecInfo]: ...
+    @overload
+    def DecodePacket(self, frame: numpy.ndarray, packet: numpy.ndarray | None, pts: int | None, pkt_data: PacketData) -> tuple[bool, TaskExecInfo]: ...
     @overload
     def DecodeSingleFrame(self, frame: numpy.ndarray, seek_ctx: SeekContext | None = ...) -> tuple[bool, TaskExecInfo]: ...
     @overload
     def DecodeSingleFrame(self, frame: numpy.ndarray, pkt_data: PacketData, seek_ctx: SeekContext | None = ...) -> tuple[bool, TaskExecInfo]: ...
     @overload
+    def DecodeSingleFrame(self, frame: HostFrame, seek_ctx: SeekContext | None = ...) -> tuple[bool, TaskExecInfo]: ...
+    @overload
+    def DecodeSingleFrame(self, frame: HostFrame, pkt_data: PacketData, seek_ctx: SeekContext | None = ...) -> tuple[bool, TaskExecInfo]: ...
+    @overload
     def DecodeSingleSurface(self, surf, seek_ctx: SeekContext | None = ...) -> tuple[bool, TaskExecInfo]: ...
     @overload
     def DecodeSingleSurface(self, surf, pkt_data: PacketData, seek_ctx: SeekContext | None = ...) -> tuple[bool, TaskExecInfo]: ...
+    def LoadIndex(self, path: str) -> None: ...
+    def SetMode(self, mode: DecodeMode) -> None: ...
+    def SetLiveMode(self, num_frames: int = ...) -> None: ...
+    def SetPrefetch(self, num_frames: int) -> None: ...
+    def Stats(self) -> DecoderStats: ...
     @property
     def AvgFramerate(self) -> float: ...
     @property
@@ -355,20 +461,30 @@ class PyDecoder:
     @property
     def HostFrameSize(self) -> int: ...
     @property
+    def Info(self) -> StreamInfo: ...
+    @property
     def IsAccelerated(self) -> bool: ...
     @property
+    def IsLive(self) -> bool: ...
+    @property
     def IsVFR(self) -> bool: ...
     @property
     def Level(self) -> int: ...
     @property
     def Metadata(self) -> dict[str, str]: ...
     @property
+    def Mode(self) -> DecodeMode: ...
+    @property
     def MotionVectors(self) -> list[MotionVector]: ...
     @property
+    def NumDropped(self) -> int: ...
+    @property
     def NumFrames(self) -> int: ...
     @property
     def NumStreams(self) -> int: ...
     @property
+    def Prefetch(self) -> int: ...
+    @property
     def Profile(self) -> int: ...
     @property
     def StartTime(self) -> float: ...
@@ -379,9 +495,29 @@ class PyDecoder:
     @property
     def Width(self) -> int: ...
 
+class PyDemuxer:
+    @overload
+    def __init__(self, input: str, opts: dict[str, str]) -> None: ...
+    @overload
+    def __init__(self, buffered_reader: object, opts: dict[str, str]) -> None: ...
+    @overload
+    def DemuxSinglePacket(self, pkt_data: PacketData) -> tuple[numpy.ndarray | None, TaskExecInfo]: ...
+    @overload
+    def DemuxSinglePacket(self) -> tuple[numpy.ndarray | None, TaskExecInfo]: ...
+    @property
+    def NumStreams(self) -> int: ...
+    @property
+    def StreamIndex(self) -> int: ...
+    @property
+    def StreamParams(self) -> StreamParams: ...
+
 class PyFrameConverter:
+    @overload
     def __init__(self, width: int, height: int, src_format: PixelFormat, dst_format: PixelFormat) -> None: ...
+    @overload
+    def __init__(self, src_width: int, src_height: int, dst_width: int, dst_height: int, src_format: PixelFormat, dst_format: PixelFormat, algorithm: ScalingAlgorithm = ..., threads: int = ...) -> None: ...
     def Run(self, src: numpy.ndarray, dst: numpy.ndarray, cc_ctx: ColorspaceConversionContext) -> tuple[bool, TaskExecInfo]: ...
+    def SetNormalization(self, mean: list[float], std: list[float]) -> None: ...
     @property
     def Format(self) -> PixelFormat: ...
 
@@ -392,6 +528,13 @@ class PyFrameUploader:
     def __init__(self, stream: int) -> None: ...
     def Run(self, src: numpy.ndarray, dst) -> tuple[bool, TaskExecInfo]: ...
 
+class PyMuxer:
+    def __init__(self, output: str, params: StreamParams, opts: dict[str, str], format: str = ..., async_write: bool = ...) -> None: ...
+    def Flush(self) -> tuple[bool, TaskExecInfo]: ...
+    def MuxSinglePacket(self, packet: numpy.ndarray[numpy.uint8], pkt_data: PacketData) -> tuple[bool, TaskExecInfo]: ...
+    @property
+    def IsAsync(self) -> bool: ...
+
 class PyNvEncoder:
     @overload
     def __init__(self, settings: dict[str, str], gpu_id: int, format: PixelFormat = ..., verbose: bool = ...) -> None: ...
@@ -426,6 +569,27 @@ class PyNvJpegEncoder:
     def Context(self, compression: int, pixel_format: PixelFormat) -> NvJpegEncodeContext: ...
     def Run(self, context: NvJpegEncodeContext, surfaces: list[Surface]) -> tuple[list[numpy.ndarray], TaskExecInfo]: ...
 
+class PyParallelDecoder:
+    def __init__(self, input: str, opts: dict[str, str], num_threads: int = ..., chunk_frames: int = ...) -> None: ...
+    @overload
+    def DecodeSingleFrame(self, frame: numpy.ndarray, pkt_data: PacketData) -> tuple[bool, TaskExecInfo]: ...
+    @overload
+    def DecodeSingleFrame(self, frame: numpy.ndarray) -> tuple[bool, TaskExecInfo]: ...
+    @property
+    def Format(self) -> PixelFormat: ...
+    @property
+    def Height(self) -> int: ...
+    @property
+    def HostFrameSize(self) -> int: ...
+    @property
+    def NumChunks(self) -> int: ...
+    @property
+    def NumFrames(self) -> int: ...
+    @property
+    def NumThreads(self) -> int: ...
+    @property
+    def Width(self) -> int: ...
+
 class PySurfaceConverter:
     @overload
     def __init__(self, src_format: PixelFormat, dst_format: PixelFormat, gpu_id: int) -> None: ...
@@ -449,6 +613,27 @@ class PySurfaceResizer:
     def Run(self, src, dst) -> tuple[bool, TaskExecInfo]: ...
     def RunAsync(self, src, dst, record_event: bool = ...) -> tuple[bool, TaskExecInfo, CudaStreamEvent]: ...
 
+class ScalingAlgorithm:
+    __members__: ClassVar[dict] = ...  # read-only
+    AREA: ClassVar[ScalingAlgorithm] = ...
+    BICUBIC: ClassVar[ScalingAlgorithm] = ...
+    BILINEAR: ClassVar[ScalingAlgorithm] = ...
+    FAST_BILINEAR: ClassVar[ScalingAlgorithm] = ...
+    LANCZOS: ClassVar[ScalingAlgorithm] = ...
+    NEAREST: ClassVar[ScalingAlgorithm] = ...
+    SPLINE: ClassVar[ScalingAlgorithm] = ...
+    __entries: ClassVar[dict] = ...
+    def __init__(self, value: int) -> None: ...
+    def __eq__(self, other: object) -> bool: ...
+    def __hash__(self) -> int: ...
+    def __index__(self) -> int: ...
+    def __int__(self) -> int: ...
+    def __ne__(self, other: object) -> bool: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def value(self) -> int: ...
+
 class SeekContext:
     seek_frame: int
     seek_tssec: float
@@ -457,6 +642,75 @@ class SeekContext:
     @overload
     def __init__(self, seek_ts: float) -> None: ...
 
+class StageStats:
+    def __init__(self, *args, **kwargs) -> None: ...
+    @property
+    def count(self) -> int: ...
+    @property
+    def histogram(self) -> list[int]: ...
+    @property
+    def total_time(self) -> float: ...
+
+class StreamInfo:
+    def __init__(self, *args, **kwargs) -> None: ...
+    @property
+    def avg_frame_rate(self) -> float: ...
+    @property
+    def bit_rate(self) -> int: ...
+    @property
+    def color_range(self) -> ColorRange: ...
+    @property
+    def color_space(self) -> ColorSpace: ...
+    @property
+    def delay(self) -> int: ...
+    @property
+    def duration(self) -> float: ...
+    @property
+    def format(self) -> PixelFormat: ...
+    @property
+    def frame_rate(self) -> float: ...
+    @property
+    def gop_size(self) -> int: ...
+    @property
+    def height(self) -> int: ...
+    @property
+    def host_frame_size(self) -> int: ...
+    @property
+    def is_vfr(self) -> int: ...
+    @property
+    def level(self) -> int: ...
+    @property
+    def metadata(self) -> dict[str, str]: ...
+    @property
+    def num_frames(self) -> int: ...
+    @property
+    def num_streams(self) -> int: ...
+    @property
+    def profile(self) -> int: ...
+    @property
+    def start_time(self) -> float: ...
+    @property
+    def stream_index(self) -> int: ...
+    @property
+    def time_base(self) -> float: ...
+    @property
+    def width(self) -> int: ...
+
+class StreamParams:
+    def __init__(self, codec: str, width: int, height: int, extradata: bytes = ..., time_base: tuple[int, int] = ...) -> None: ...
+    @property
+    def Codec(self) -> str: ...
+    @property
+    def Extradata(self) -> bytes: ...
+    @property
+    def Format(self) -> PixelFormat: ...
+    @property
+    def Height(self) -> int: ...
+    @property
+    def Timebase(self) -> float: ...
+    @property
+    def Width(self) -> int: ...
+
 class Surface:
     def __init__(self, *args, **kwargs) -> None: ...
     def Clone(self) -> Surface: ...
@@ -542,6 +796,8 @@ class TaskExecInfo:
     @property
     def value(self) -> int: ...
 
+def GetDecodeThreadBudget() -> int: ...
 def GetNumGpus() -> int: ...
 def GetNvencParams() -> dict[str, str]: ...
+def SetDecodeThreadBudget(num_cores: int) -> None: ...
 def SetFFMpegLogLevel(arg0: FfmpegLogLevel) -> None: ...
@@ -22,7 +22,11 @@
 #include "TC_CORE.hpp"
 #include "Tasks.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <pybind11/cast.h>
@@ -31,6 +35,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 extern "C" {
 #include <libavformat/avio.h>
@@ -94,8 +100,10 @@ public:
 class PyFrameConverter {
   std::unique_ptr<ConvertFrame> m_up_cvt = nullptr;
   std::unique_ptr<Buffer> m_up_ctx_buf = nullptr;
-  size_t m_width = 0U;
-  size_t m_height = 0U;
+  size_t m_src_width = 0U;
+  size_t m_src_height = 0U;
+  size_t m_dst_width = 0U;
+  size_t m_dst_height = 0U;
   Pixel_Format m_src_fmt = Pixel_Format::UNDEFINED;
   Pixel_Format m_dst_fmt = Pixel_Format::UNDEFINED;
 
@@ -103,10 +111,18 @@ public:
   PyFrameConverter(uint32_t width, uint32_t height, Pixel_Format inFormat,
                    Pixel_Format outFormat);
 
+  PyFrameConverter(uint32_t src_width, uint32_t src_height,
+                   uint32_t dst_width, uint32_t dst_height,
+                   Pixel_Format inFormat, Pixel_Format outFormat,
+                   ScalingAlgorithm algorithm, uint32_t num_threads);
+
   bool Run(py::array& src, py::array& dst,
            std::shared_ptr<ColorspaceConversionContext> context,
            TaskExecDetails& details);
 
+  void SetNormalization(const std::array<float, 3>& mean,
+                        const std::array<float, 3>& std);
+
   Pixel_Format GetFormat() const { return m_dst_fmt; }
 };
 
@@ -165,8 +181,15 @@ public:
 
 class BufferedReader {
 public:
-  BufferedReader(py::object obj);
-  ~BufferedReader() = default;
+  /* If read_ahead isn't zero, helper thread reads data from Python object to
+   * the ring of given size in advance. Then decoder takes data from the ring
+   * and never waits for GIL unless the ring is empty.
+   */
+  BufferedReader(py::object obj, size_t read_ahead = 0U);
+  ~BufferedReader();
+
+  BufferedReader(const BufferedReader& other) = delete;
+  BufferedReader& operator=(const BufferedReader& other) = delete;
 
   static int read(void* self, uint8_t* buf, int buf_size);
   static int64_t seek(void* self, int64_t offset, int whence);
@@ -176,16 +199,180 @@ public:
                                                                    1024U);
 
 private:
+  /* Reads up to size bytes from Python object to given memory. Returns
+   * number of bytes read, 0 at EOF or negative AVERROR in case of failure.
+   */
+  int ReadFromObject(uint8_t* buf, size_t size);
+
+  // Read-ahead helper thread loop and ring consumer.
+  void ReadAhead();
+  int ReadFromRing(uint8_t* buf, size_t size);
+
   py::object m_obj = py::none();
   size_t m_buffer_size = 0U;
   std::shared_ptr<AVIOContext> m_io_ctx_ptr;
   bool m_is_seekable = true;
+  bool m_has_readinto = false;
+
+  // Read-ahead ring, first filled byte and number of filled bytes.
+  std::vector<uint8_t> m_ring;
+  size_t m_head = 0U;
+  size_t m_size = 0U;
+
+  // Sticky result of last helper thread read, EOF or error.
+  int m_status = 0;
+  bool m_stop = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
+};
+
+/* Reads input from memory. Unlike BufferedReader it never calls Python code
+ * and doesn't take GIL. Memory is either Python buffer kept alive by the
+ * reader or the file mapped with mmap.
+ */
+class MemoryReader {
+public:
+  // Buffer must be C-contiguous.
+  MemoryReader(py::buffer buffer);
+
+  // File descriptor isn't owned by reader, mapping outlives it.
+  MemoryReader(int fd);
+
+  ~MemoryReader();
+
+  MemoryReader(const MemoryReader& other) = delete;
+  MemoryReader& operator=(const MemoryReader& other) = delete;
+
+  static int read(void* self, uint8_t* buf, int buf_size);
+  static int64_t seek(void* self, int64_t offset, int whence);
+
+  /* Data is already in memory, so buffer only needs to be big enough to
+   * keep number of read calls low. Default buffer size is 64KB.
+   */
+  std::shared_ptr<AVIOContext> GetAVIOContext(size_t buffer_size = 64 *
+                                                                   1024U);
+
+private:
+  std::unique_ptr<py::buffer_info> m_buffer_info;
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0U;
+  size_t m_pos = 0U;
+  std::shared_ptr<AVIOContext> m_io_ctx_ptr;
+
+#ifdef _WIN32
+  void* m_mapping = nullptr;
+#endif
+  void* m_mapped = nullptr;
+};
+
+/* Single plane of HostFrame. Keeps frame memory alive.
+ */
+struct HostFramePlane {
+  std::shared_ptr<HostFrame> frame;
+  uint32_t plane;
+};
+
+/* Runs decoder on a background thread and keeps up to N decoded frames in a
+ * ring of preallocated host buffers.
+ */
+class FramePrefetcher {
+public:
+  /* Decodes single frame into given buffer. Buffer may be resized to fit the
+   * frame.
+   */
+  using DecodeFunc =
+      std::function<TaskExecDetails(std::vector<uint8_t>&, PacketData&)>;
+
+  // Called every time oldest frame is dropped.
+  using DropFunc = std::function<void()>;
+
+  /* If drop_func is given, decoding never blocks. When ring is full, oldest
+   * frame is dropped to make room for the new one, so ring keeps the most
+   * recent frames.
+   */
+  FramePrefetcher(size_t num_frames, DecodeFunc decode_func,
+                  DropFunc drop_func = nullptr);
+  ~FramePrefetcher();
+
+  /* Blocks until next frame is ready and copies it to dst.
+   * Once decoder fails or hits EOS, every following call returns same details.
+   */
+  TaskExecDetails Pop(py::array& dst, PacketData& pkt_data);
+
+  /* Same as above but copies to raw memory of given size. Frame isn't popped
+   * if its size doesn't match.
+   */
+  TaskExecDetails Pop(uint8_t* dst, size_t dst_size, PacketData& pkt_data);
+
+  size_t Capacity() const { return m_capacity; }
+
+  bool IsDropOldest() const { return m_drop_func != nullptr; }
+
+private:
+  struct Slot {
+    std::vector<uint8_t> frame;
+    PacketData pkt_data = {};
+    TaskExecDetails details;
+  };
+
+  /* Returns pointer to memory of given size to copy frame to or nullptr
+   * if there's no such memory.
+   */
+  using DstFunc = std::function<uint8_t*(size_t)>;
+
+  TaskExecDetails Pop(DstFunc get_dst, PacketData& pkt_data);
+
+  void Run();
+
+  // Drops oldest frame. Called with lock held when ring is full.
+  void DropOldest();
+
+  /* When dropping oldest frames, one extra slot is kept to decode into while
+   * ring is full.
+   */
+  size_t m_capacity;
+  std::vector<Slot> m_slots;
+  DecodeFunc m_decode_func;
+  DropFunc m_drop_func;
+
+  // First filled slot and number of filled slots.
+  size_t m_head = 0U;
+  size_t m_size = 0U;
+  bool m_stop = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
 };
 
 class PyDecoder {
-  std::unique_ptr<DecodeFrame> upDecoder = nullptr;
+  /* Guards decoder against concurrent access from prefetch thread and
+   * synchronous calls. Never taken with GIL held, prefetch thread may need
+   * GIL to read input while holding it.
+   */
+  mutable std::mutex m_mutex;
+
+  /* Parameters snapshot updated after every decoder call. Property getters
+   * are served from it, so they don't wait for decode.
+   */
+  mutable std::mutex m_params_mutex;
+  std::shared_ptr<const MuxingParams> m_params = nullptr;
+  std::atomic<bool> m_is_accelerated{false};
+
+  // Declared before decoder to outlive it, decoder reads from them.
+  std::unique_ptr<MemoryReader> upMem = nullptr;
   std::unique_ptr<BufferedReader> upBuff = nullptr;
 
+  std::unique_ptr<DecodeFrame> upDecoder = nullptr;
+
+  // Frames dropped by prefetcher in live mode.
+  std::atomic<uint64_t> m_num_dropped{0U};
+
+  // Declared last to be destroyed first, it uses decoder from another thread.
+  std::unique_ptr<FramePrefetcher> upPrefetcher = nullptr;
+
   void* GetSideData(AVFrameSideDataType data_type, size_t& raw_size);
 
   uint32_t last_w;
@@ -193,6 +380,7 @@ class PyDecoder {
   int gpu_id;
 
   void UpdateState();
+  std::shared_ptr<const MuxingParams> GetParams() const;
 
 public:
   PyDecoder(const std::string& pathToFile,
@@ -201,16 +389,81 @@ public:
 
   PyDecoder(py::object buffered_reader,
             const std::map<std::string, std::string>& ffmpeg_options,
+            int gpuID, size_t read_ahead = 0U);
+
+  /* Reads input from memory without GIL. Buffer is kept alive by decoder.
+   */
+  PyDecoder(py::buffer buffer,
+            const std::map<std::string, std::string>& ffmpeg_options,
+            int gpuID);
+
+  /* Reads input from file descriptor which is mapped to memory.
+   * Decoder doesn't close the file descriptor.
+   */
+  PyDecoder(int fd, const std::map<std::string, std::string>& ffmpeg_options,
             int gpuID);
 
+  // Standalone decoder, packets are given by user.
+  PyDecoder(const StreamParams& params,
+            const std::map<std::string, std::string>& ffmpeg_options,
+            int gpuID);
+
+  ~PyDecoder();
+
+  /* Sends packet to standalone decoder and receives single frame. Pass
+   * nullptr packet to flush decoder.
+   */
+  bool DecodePacket(py::array& frame, const uint8_t* packet,
+                    size_t packet_size, std::optional<int64_t> pts,
+                    TaskExecDetails& details, PacketData& pkt_data);
+
   bool DecodeSingleFrame(py::array& frame, TaskExecDetails& details,
                          PacketData& pkt_data,
                          std::optional<SeekContext> seek_ctx);
 
+  bool DecodeSingleFrame(HostFrame& frame, TaskExecDetails& details,
+                         PacketData& pkt_data,
+                         std::optional<SeekContext> seek_ctx);
+
   bool DecodeSingleSurface(Surface& surf, TaskExecDetails& details,
                            PacketData& pkt_data,
                            std::optional<SeekContext> seek_ctx);
 
+  /* Decodes up to num_frames frames into contiguous memory, frame_size bytes
+   * per frame. Packet pts, dts and key flag of every frame are written to
+   * pkt_info. Stops at first frame which isn't decoded successfully or
+   * has different size. Returns number of decoded frames.
+   */
+  size_t DecodeBatch(size_t num_frames, size_t frame_size, uint8_t* frames,
+                     int64_t* pkt_info, TaskExecDetails& details);
+
+  /* Decodes frames with given numbers into contiguous memory, frame_size
+   * bytes per frame, in the same order as numbers are given. Packet pts, dts
+   * and key flag of every frame are written to pkt_info.
+   * Frames are decoded in ascending order, so every GOP is visited once.
+   */
+  bool DecodeFrames(const std::vector<int64_t>& frame_nums, size_t frame_size,
+                    uint8_t* frames, int64_t* pkt_info,
+                    TaskExecDetails& details);
+
+  void SetPrefetch(size_t num_frames);
+  size_t GetPrefetch() const;
+
+  /* Starts background decoding which keeps given number of the most recent
+   * frames, older ones are dropped.
+   */
+  void SetLiveMode(size_t num_frames);
+  bool IsLive() const;
+
+  // Returns number of frames dropped in live mode.
+  uint64_t NumDropped() const;
+
+  void BuildIndex(const std::string& path);
+  void LoadIndex(const std::string& path);
+
+  void SetMode(DecodeMode mode);
+  DecodeMode GetMode() const;
+
   std::vector<MotionVector> GetMotionVectors();
 
   uint32_t Width() const;
@@ -241,9 +494,159 @@ public:
 
   std::map<std::string, std::string> Metadata();
 
+  // All stream parameters at once.
+  VideoContext Info() const;
+
+  DecoderStats Stats() const;
+
 private:
+  void StartPrefetch(size_t num_frames, bool drop_oldest);
+
   bool DecodeImpl(TaskExecDetails& details, PacketData& pkt_data, Token& dst,
                   std::optional<SeekContext> seek_ctx);
+
+  // Same as above, caller must hold decoder lock.
+  bool DecodeLocked(TaskExecDetails& details, PacketData& pkt_data,
+                    Token& dst, std::optional<SeekContext> seek_ctx);
+};
+
+/* Decodes single video file with multiple independent decoders running in
+ * separate threads. File is split into chunks at key frames with help of
+ * packet index, chunks are distributed between decoders round-robin.
+ * Every decoder keeps up to one chunk of decoded frames, they are returned
+ * in presentation order.
+ */
+class PyParallelDecoder {
+public:
+  PyParallelDecoder(const std::string& pathToFile,
+                    const std::map<std::string, std::string>& ffmpeg_options,
+                    size_t num_threads, size_t chunk_frames);
+  ~PyParallelDecoder();
+
+  /* Blocks until next frame is ready and returns its size in bytes.
+   * Returns 0 if there will be no more frames.
+   */
+  size_t WaitFrame();
+
+  /* Blocks until next frame is ready and copies it to dst.
+   * Once decoder fails or hits EOS, every following call returns same details.
+   */
+  bool DecodeSingleFrame(uint8_t* dst, size_t dst_size,
+                         TaskExecDetails& details, PacketData& pkt_data);
+
+  uint32_t Width() const;
+  uint32_t Height() const;
+  uint32_t NumFrames() const;
+  uint32_t HostFrameSize() const;
+  size_t NumThreads() const { return m_workers.size(); }
+  size_t NumChunks() const { return m_chunks.size(); }
+  Pixel_Format PixelFormat() const;
+
+private:
+  // Range of frames in presentation order.
+  struct Chunk {
+    int64_t start;
+    int64_t num_frames;
+  };
+
+  struct Slot {
+    std::vector<uint8_t> frame;
+    PacketData pkt_data = {};
+    TaskExecDetails details;
+    // Last frame of the chunk.
+    bool chunk_end = false;
+  };
+
+  struct Worker {
+    std::unique_ptr<DecodeFrame> decoder;
+    std::deque<Slot> queue;
+    // Frame buffers returned by consumer for reuse.
+    std::vector<std::vector<uint8_t>> free_frames;
+    std::thread thread;
+  };
+
+  void Run(Worker& worker, size_t first_chunk);
+
+  std::vector<Chunk> m_chunks;
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  MuxingParams m_params;
+
+  size_t m_queue_size = 0U;
+  size_t m_cur_chunk = 0U;
+  bool m_stop = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+};
+
+/* Reads compressed video packets without decoding them.
+ */
+class PyDemuxer {
+  // Declared before demuxer to outlive it, demuxer reads from it.
+  std::unique_ptr<BufferedReader> upBuff = nullptr;
+  std::unique_ptr<DemuxFrame> upDemuxer = nullptr;
+
+public:
+  PyDemuxer(const std::string& pathToFile,
+            const std::map<std::string, std::string>& ffmpeg_options);
+
+  PyDemuxer(py::object buffered_reader,
+            const std::map<std::string, std::string>& ffmpeg_options);
+
+  /* Reads next video packet. Packet data isn't copied, pkt references it.
+   */
+  bool DemuxSinglePacket(std::shared_ptr<AVPacket>& pkt,
+                         TaskExecDetails& details, PacketData& pkt_data);
+
+  const StreamParams& GetStreamParams() const;
+  int StreamIndex() const;
+  int NumStreams() const;
+};
+
+/* Wraps packet into read-only numpy array without copy. Array keeps packet
+ * reference alive.
+ */
+py::array MakePacketArray(std::shared_ptr<AVPacket> pkt);
+
+class PyMuxer {
+  std::unique_ptr<MuxFrame> upMuxer = nullptr;
+
+public:
+  PyMuxer(const std::string& pathToFile, const StreamParams& params,
+          const std::map<std::string, std::string>& ffmpeg_options,
+          const std::string& format, bool async);
+
+  /* Writes single packet. Timestamps are taken from pkt_data if it's given.
+   */
+  bool MuxSinglePacket(const uint8_t* packet, size_t packet_size,
+                       const PacketData* pkt_data, TaskExecDetails& details);
+
+  // Writes pending packets and container trailer.
+  bool Flush(TaskExecDetails& details);
+
+  bool IsAsync() const;
+};
+
+/* Cuts clips from single input without re-encoding. Input is opened once and
+ * reused for all the cuts.
+ */
+class PyClipCutter {
+  std::unique_ptr<DemuxFrame> upDemuxer = nullptr;
+  std::map<std::string, std::string> m_mux_options;
+
+public:
+  PyClipCutter(const std::string& pathToFile,
+               const std::map<std::string, std::string>& ffmpeg_options,
+               const std::map<std::string, std::string>& mux_options);
+
+  /* Writes packets between start and end timestamps given in seconds from
+   * stream start time to output. Clip starts from key frame at or before
+   * start timestamp if snap_backward is true, from key frame at or after it
+   * otherwise.
+   */
+  bool Cut(double start, double end, const std::string& output,
+           const std::string& format, bool snap_backward,
+           TaskExecDetails& details);
 };
 
 class PyNvEncoder {
@@ -14,9 +14,12 @@
 
 #include "VALI.hpp"
 
+#include <algorithm>
+
 namespace py = pybind11;
 
-BufferedReader::BufferedReader(py::object obj) : m_obj(obj) {
+BufferedReader::BufferedReader(py::object obj, size_t read_ahead)
+    : m_obj(obj) {
   py::gil_scoped_acquire acq;
 
   // Do this outside try-catch block because read attribute is mandatory.
@@ -28,38 +31,139 @@ BufferedReader::BufferedReader(py::object obj) : m_obj(obj) {
   } catch (...) {
     m_is_seekable = false;
   }
+
+  // Saves a copy from bytes object returned by read.
+  m_has_readinto = py::hasattr(m_obj, "readinto");
+
+  if (read_ahead) {
+    m_ring.resize(read_ahead);
+    m_thread = std::thread(&BufferedReader::ReadAhead, this);
+  }
 }
 
-int BufferedReader::read(void* self, uint8_t* buf, int buf_size) {
-  auto me = static_cast<BufferedReader*>(self);
+BufferedReader::~BufferedReader() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+
+  // Helper thread may be waiting for GIL.
+  if (PyGILState_Check()) {
+    py::gil_scoped_release gil_release;
+    m_thread.join();
+  } else {
+    m_thread.join();
+  }
+}
+
+int BufferedReader::ReadFromObject(uint8_t* buf, size_t size) {
   try {
     py::gil_scoped_acquire acq;
 
-    if (!me || !buf || buf_size <= 0 || buf_size > me->m_buffer_size) {
-      std::cerr << __FUNCTION__ << "Invalid argument given";
-      return AVERROR_UNKNOWN;
+    if (m_has_readinto) {
+      auto view = py::memoryview::from_memory(buf, size);
+      auto res = m_obj.attr("readinto")(view);
+      view.attr("release")();
+
+      // Non-blocking stream without data available, treated as EOF.
+      return res.is_none() ? 0 : res.cast<int>();
     }
 
     /* Get read method and run it. It return bytes so we have to memcpy from
      * bytes to actual buffer
      */
-    auto read_func =
-        py::reinterpret_borrow<py::function>(me->m_obj.attr("read"));
-    py::buffer_info info(py::buffer(read_func(buf_size)).request());
-
-    auto const num_bytes = info.shape[0];
-    if (num_bytes) {
-      memcpy((void*)buf, info.ptr, num_bytes);
-      return num_bytes;
-    } else {
-      return AVERROR_EOF;
-    }
+    auto read_func = py::reinterpret_borrow<py::function>(m_obj.attr("read"));
+    py::buffer_info info(py::buffer(read_func(size)).request());
+
+    auto const num_bytes = std::min((size_t)info.shape[0], size);
+    memcpy((void*)buf, info.ptr, num_bytes);
+    return num_bytes;
   } catch (std::exception& e) {
     std::cerr << e.what();
     return AVERROR_UNKNOWN;
   }
 }
 
+void BufferedReader::ReadAhead() {
+  auto const capacity = m_ring.size();
+
+  // Big enough to make GIL round trips rare, small enough to refill early.
+  auto const chunk_size = std::max(capacity / 4U, (size_t)1U);
+
+  while (true) {
+    size_t tail = 0U, size = 0U;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&] { return m_stop || m_size < capacity; });
+      if (m_stop) {
+        return;
+      }
+
+      /* Helper thread owns free part of the ring, consumer owns filled part.
+       * So data is read directly to the ring without holding the lock.
+       */
+      tail = (m_head + m_size) % capacity;
+      size = std::min({capacity - m_size, capacity - tail, chunk_size});
+    }
+
+    auto const res = ReadFromObject(m_ring.data() + tail, size);
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (res > 0) {
+        m_size += res;
+      } else {
+        m_status = res ? res : AVERROR_EOF;
+      }
+    }
+    m_cv.notify_all();
+
+    // Nothing else can be read after EOF or error.
+    if (res <= 0) {
+      return;
+    }
+  }
+}
+
+int BufferedReader::ReadFromRing(uint8_t* buf, size_t size) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [&] { return m_size || m_status; });
+  if (!m_size) {
+    return m_status;
+  }
+
+  auto const capacity = m_ring.size();
+  auto const num_bytes = std::min(size, m_size);
+  auto const first = std::min(num_bytes, capacity - m_head);
+  memcpy(buf, m_ring.data() + m_head, first);
+  memcpy(buf + first, m_ring.data(), num_bytes - first);
+
+  m_head = (m_head + num_bytes) % capacity;
+  m_size -= num_bytes;
+  lock.unlock();
+  m_cv.notify_all();
+
+  return num_bytes;
+}
+
+int BufferedReader::read(void* self, uint8_t* buf, int buf_size) {
+  auto me = static_cast<BufferedReader*>(self);
+  if (!me || !buf || buf_size <= 0 || buf_size > me->m_buffer_size) {
+    std::cerr << __FUNCTION__ << "Invalid argument given";
+    return AVERROR_UNKNOWN;
+  }
+
+  // Read-ahead ring is consumed without GIL.
+  auto const num_bytes = me->m_thread.joinable()
+                             ? me->ReadFromRing(buf, buf_size)
+                             : me->ReadFromObject(buf, buf_size);
+  return num_bytes ? num_bytes : AVERROR_EOF;
+}
+
 int64_t BufferedReader::seek(void* self, int64_t offset, int whence) {
   auto me = static_cast<BufferedReader*>(self);
   try {
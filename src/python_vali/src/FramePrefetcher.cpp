@@ -0,0 +1,153 @@
+/*
+ * Copyright 2024 VisionLabs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+
+namespace py = pybind11;
+
+FramePrefetcher::FramePrefetcher(size_t num_frames, DecodeFunc decode_func,
+                                 DropFunc drop_func)
+    : m_capacity(num_frames), m_slots(drop_func ? num_frames + 1 : num_frames),
+      m_decode_func(decode_func), m_drop_func(drop_func) {
+  if (!num_frames) {
+    throw std::invalid_argument("Prefetch ring can't be empty");
+  }
+
+  m_thread = std::thread(&FramePrefetcher::Run, this);
+}
+
+FramePrefetcher::~FramePrefetcher() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void FramePrefetcher::Run() {
+  while (true) {
+    size_t tail = 0U;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&] { return m_stop || m_size < m_slots.size(); });
+      if (m_stop) {
+        return;
+      }
+      tail = (m_head + m_size) % m_slots.size();
+    }
+
+    /* Slot isn't visible to consumer until m_size is incremented, so it's
+     * safe to decode into it without holding the lock.
+     */
+    auto& slot = m_slots[tail];
+    slot.pkt_data = {};
+    try {
+      slot.details = m_decode_func(slot.frame, slot.pkt_data);
+    } catch (std::exception& e) {
+      slot.details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                                     TaskExecInfo::FAIL, e.what());
+    }
+
+    auto const is_last =
+        (slot.details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS);
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      // EOS or error doesn't push out the last frames.
+      if (m_drop_func && !is_last && m_size >= m_capacity) {
+        DropOldest();
+      }
+      m_size++;
+    }
+    m_cv.notify_all();
+
+    // Decoder won't produce anything after EOS or error.
+    if (is_last) {
+      return;
+    }
+  }
+}
+
+void FramePrefetcher::DropOldest() {
+  /* Resolution change has no pixels but tells consumer that frame size has
+   * changed, so it's kept and the frame next to it is dropped instead.
+   */
+  if (m_slots[m_head].details.m_info == TaskExecInfo::RES_CHANGE) {
+    if (m_size < 2U) {
+      return;
+    }
+    std::swap(m_slots[m_head], m_slots[(m_head + 1) % m_slots.size()]);
+  }
+
+  m_head = (m_head + 1) % m_slots.size();
+  m_size--;
+  m_drop_func();
+}
+
+TaskExecDetails FramePrefetcher::Pop(py::array& dst, PacketData& pkt_data) {
+  auto get_dst = [&](size_t size) {
+    if (dst.nbytes() != size) {
+      dst.resize({size}, false);
+    }
+    return static_cast<uint8_t*>(dst.mutable_data());
+  };
+
+  return Pop(get_dst, pkt_data);
+}
+
+TaskExecDetails FramePrefetcher::Pop(uint8_t* dst, size_t dst_size,
+                                     PacketData& pkt_data) {
+  auto get_dst = [&](size_t size) { return size == dst_size ? dst : nullptr; };
+  return Pop(get_dst, pkt_data);
+}
+
+TaskExecDetails FramePrefetcher::Pop(DstFunc get_dst, PacketData& pkt_data) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [&] { return m_size > 0U; });
+
+  auto& slot = m_slots[m_head];
+  pkt_data = slot.pkt_data;
+
+  /* Failed slot is the last one. Keep it in the ring so that every following
+   * call returns same details.
+   */
+  if (slot.details.m_status != TaskExecStatus::TASK_EXEC_SUCCESS) {
+    return slot.details;
+  }
+
+  /* Upon resolution change decoder doesn't return pixels, see
+   * DecodeFrame::Run. Keep same behavior.
+   */
+  if (slot.details.m_info != TaskExecInfo::RES_CHANGE) {
+    auto dst = get_dst(slot.frame.size());
+    if (!dst) {
+      return TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                             TaskExecInfo::SRC_DST_SIZE_MISMATCH,
+                             "frame size mismatch");
+    }
+    memcpy(dst, slot.frame.data(), slot.frame.size());
+  }
+
+  auto details = slot.details;
+  m_head = (m_head + 1) % m_slots.size();
+  m_size--;
+
+  lock.unlock();
+  m_cv.notify_all();
+
+  return details;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2024 VisionLabs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace py = pybind11;
+
+MemoryReader::MemoryReader(py::buffer buffer) {
+  m_buffer_info = std::make_unique<py::buffer_info>(buffer.request());
+
+  auto const& info = *m_buffer_info;
+  if (!PyBuffer_IsContiguous(info.view(), 'C')) {
+    throw std::invalid_argument("Buffer must be C-contiguous");
+  }
+
+  m_data = static_cast<const uint8_t*>(info.ptr);
+  m_size = info.size * info.itemsize;
+}
+
+MemoryReader::MemoryReader(int fd) {
+#ifdef _WIN32
+  auto file = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+  if (INVALID_HANDLE_VALUE == file) {
+    throw std::invalid_argument("Invalid file descriptor");
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    throw std::runtime_error("Can't get file size");
+  }
+  m_size = size.QuadPart;
+
+  if (m_size) {
+    m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    m_mapped = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)
+                         : nullptr;
+    if (!m_mapped) {
+      if (m_mapping) {
+        CloseHandle(m_mapping);
+      }
+      throw std::runtime_error("Can't map file");
+    }
+  }
+#else
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    throw std::invalid_argument("Invalid file descriptor");
+  }
+  m_size = st.st_size;
+
+  if (m_size) {
+    m_mapped = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == m_mapped) {
+      m_mapped = nullptr;
+      throw std::runtime_error("Can't map file");
+    }
+
+    // Input is mostly read front to back.
+    madvise(m_mapped, m_size, MADV_SEQUENTIAL);
+  }
+#endif
+
+  m_data = static_cast<const uint8_t*>(m_mapped);
+}
+
+MemoryReader::~MemoryReader() {
+  if (m_mapped) {
+#ifdef _WIN32
+    UnmapViewOfFile(m_mapped);
+    CloseHandle(m_mapping);
+#else
+    munmap(m_mapped, m_size);
+#endif
+  }
+
+  // Python buffer has to be released with GIL held.
+  if (m_buffer_info) {
+    py::gil_scoped_acquire acq;
+    m_buffer_info.reset();
+  }
+}
+
+int MemoryReader::read(void* self, uint8_t* buf, int buf_size) {
+  auto me = static_cast<MemoryReader*>(self);
+  if (!me || !buf || buf_size <= 0) {
+    return AVERROR(EINVAL);
+  }
+
+  auto const num_bytes = std::min(me->m_size - me->m_pos, (size_t)buf_size);
+  if (!num_bytes) {
+    return AVERROR_EOF;
+  }
+
+  memcpy(buf, me->m_data + me->m_pos, num_bytes);
+  me->m_pos += num_bytes;
+  return (int)num_bytes;
+}
+
+int64_t MemoryReader::seek(void* self, int64_t offset, int whence) {
+  auto me = static_cast<MemoryReader*>(self);
+  if (!me) {
+    return AVERROR(EINVAL);
+  }
+
+  if (whence & AVSEEK_SIZE) {
+    return me->m_size;
+  }
+
+  // Seek is always cheap, so there's nothing to force.
+  int64_t pos = 0;
+  switch (whence & ~AVSEEK_FORCE) {
+  case SEEK_SET:
+    pos = offset;
+    break;
+  case SEEK_CUR:
+    pos = me->m_pos + offset;
+    break;
+  case SEEK_END:
+    pos = me->m_size + offset;
+    break;
+  default:
+    return AVERROR(EINVAL);
+  }
+
+  if (pos < 0 || pos > (int64_t)me->m_size) {
+    return AVERROR(EINVAL);
+  }
+
+  me->m_pos = pos;
+  return pos;
+}
+
+std::shared_ptr<AVIOContext> MemoryReader::GetAVIOContext(size_t buffer_size) {
+  if (m_io_ctx_ptr) {
+    return m_io_ctx_ptr;
+  }
+
+  auto buf = static_cast<unsigned char*>(av_malloc(buffer_size));
+  if (!buf) {
+    throw std::bad_alloc();
+  }
+
+  AVIOContext* io_ctx = avio_alloc_context(
+      buf, buffer_size, 0, static_cast<void*>(this), MemoryReader::read,
+      nullptr, MemoryReader::seek);
+
+  if (!io_ctx) {
+    av_free(buf);
+    throw std::bad_alloc();
+  }
+
+  /* Buffer may be reallocated by AVIO, so it's freed through the context
+   * and not by saved pointer.
+   */
+  m_io_ctx_ptr = std::shared_ptr<AVIOContext>(io_ctx, [](void* p) {
+    AVIOContext* p_ctx = static_cast<AVIOContext*>(p);
+    av_freep(&p_ctx->buffer);
+    avio_context_free(&p_ctx);
+  });
+
+  return m_io_ctx_ptr;
+}
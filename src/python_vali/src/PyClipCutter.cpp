@@ -0,0 +1,189 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+
+#include <cmath>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+using namespace std;
+using namespace VPF;
+
+namespace py = pybind11;
+
+constexpr auto TASK_EXEC_SUCCESS = TaskExecStatus::TASK_EXEC_SUCCESS;
+constexpr auto TASK_EXEC_FAIL = TaskExecStatus::TASK_EXEC_FAIL;
+
+PyClipCutter::PyClipCutter(const string& pathToFile,
+                           const map<string, string>& ffmpeg_options,
+                           const map<string, string>& mux_options)
+    : m_mux_options(mux_options) {
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  upDemuxer.reset(DemuxFrame::Make(pathToFile.c_str(), cli_iface));
+}
+
+bool PyClipCutter::Cut(double start, double end, const string& output,
+                       const string& format, bool snap_backward,
+                       TaskExecDetails& details) {
+  if (end <= start) {
+    details = TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::INVALID_INPUT,
+                              "clip end must be greater than start");
+    return false;
+  }
+
+  // Seconds are counted from stream start time, same as decoder seek does.
+  auto const& params = upDemuxer->GetStreamParams();
+  auto const time_base = av_q2d(params.time_base);
+  auto const start_time = upDemuxer->GetStreamStartTime();
+  auto const start_ts = start_time + (int64_t)std::llround(start / time_base);
+  auto const end_ts = start_time + (int64_t)std::llround(end / time_base);
+
+  details = upDemuxer->Seek(start_ts);
+  if (TASK_EXEC_SUCCESS != details.m_status) {
+    return false;
+  }
+
+  /* Muxer is created upon first key frame within the range, so no broken
+   * file is left if there's none.
+   */
+  std::unique_ptr<MuxFrame> upMuxer = nullptr;
+  auto offset = AV_NOPTS_VALUE;
+
+  while (true) {
+    details = upDemuxer->Execute();
+    if (TaskExecInfo::END_OF_STREAM == details.m_info) {
+      break;
+    } else if (TASK_EXEC_SUCCESS != details.m_status) {
+      return false;
+    }
+
+    auto pkt_data = upDemuxer->GetLastPacketData();
+    auto const dts =
+        (AV_NOPTS_VALUE != pkt_data.dts) ? pkt_data.dts : pkt_data.pts;
+
+    if (!upMuxer) {
+      // Clip must begin with key frame, otherwise it can't be decoded.
+      if (!pkt_data.key || (!snap_backward && pkt_data.pts < start_ts)) {
+        continue;
+      }
+
+      if (pkt_data.pts >= end_ts) {
+        break;
+      }
+
+      try {
+        NvDecoderClInterface cli_iface(m_mux_options);
+        upMuxer.reset(
+            MuxFrame::Make(output.c_str(), params, cli_iface, format));
+      } catch (std::exception& e) {
+        details = TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::FAIL, e.what());
+        return false;
+      }
+      offset = dts;
+    } else if (dts >= end_ts) {
+      // Packets come in decode order, all the following ones are later.
+      break;
+    }
+
+    // Clip timestamps start from zero.
+    if (AV_NOPTS_VALUE != pkt_data.pts) {
+      pkt_data.pts -= offset;
+    }
+    if (AV_NOPTS_VALUE != pkt_data.dts) {
+      pkt_data.dts -= offset;
+    }
+
+    auto pkt = upDemuxer->GetLastPacket();
+    auto pkt_buf =
+        std::shared_ptr<Buffer>(Buffer::Make(pkt->size, (void*)pkt->data));
+    auto pkt_data_buf = std::shared_ptr<Buffer>(
+        Buffer::Make(sizeof(pkt_data), static_cast<void*>(&pkt_data)));
+
+    upMuxer->ClearInputs();
+    upMuxer->SetInput(pkt_buf.get(), 0U);
+    upMuxer->SetInput(pkt_data_buf.get(), 1U);
+    details = upMuxer->Execute();
+    upMuxer->ClearInputs();
+
+    if (TASK_EXEC_SUCCESS != details.m_status) {
+      return false;
+    }
+  }
+
+  if (!upMuxer) {
+    details = TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::INVALID_INPUT,
+                              "no key frame within given range");
+    return false;
+  }
+
+  details = upMuxer->Flush();
+  return TASK_EXEC_SUCCESS == details.m_status;
+}
+
+void Init_PyClipCutter(py::module& m) {
+  py::class_<PyClipCutter, shared_ptr<PyClipCutter>>(
+      m, "PyClipCutter",
+      "Cuts clips from video file without re-encoding. Input is opened once "
+      "and reused for all the clips.")
+      .def(py::init<const string&, const map<string, string>&,
+                    const map<string, string>&>(),
+           py::arg("input"), py::arg("opts"),
+           py::arg("mux_opts") = map<string, string>(),
+           R"pbdoc(
+        Constructor method.
+
+        :param input: path to input file
+        :param opts: AVDictionary options that will be passed to AVFormat context.
+        :param mux_opts: AVDictionary options that will be passed to muxer of every clip.
+    )pbdoc")
+      .def(
+          "Cut",
+          [](PyClipCutter& self, const vector<pair<double, double>>& ranges,
+             const vector<string>& outputs, const string& format,
+             bool snap_backward) {
+            if (ranges.size() != outputs.size()) {
+              throw std::invalid_argument(
+                  "Number of ranges and outputs must match");
+            }
+
+            vector<tuple<bool, TaskExecInfo>> results;
+            for (auto i = 0U; i < ranges.size(); i++) {
+              TaskExecDetails details;
+              auto const res =
+                  self.Cut(ranges[i].first, ranges[i].second, outputs[i],
+                           format, snap_backward, details);
+              results.push_back(std::make_tuple(res, details.m_info));
+            }
+            return results;
+          },
+          py::arg("ranges"), py::arg("outputs"), py::arg("format") = "",
+          py::arg("snap_backward") = true,
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Write every range to its own output without re-encoding.
+        Clip can only start from key frame. By default it's the key frame at or
+        before range start, so clip contains whole range. Otherwise it's the
+        key frame at or after range start. Clip ends at first packet which
+        decode timestamp is equal or greater than range end.
+
+        :param ranges: list of (start, end) tuples in seconds counted from video stream start time, same as seek of PyDecoder
+        :param outputs: list of output file paths, one per range
+        :param format: container format name. Guessed from output file extension if empty.
+        :param snap_backward: start clip from key frame before range start
+        :return: list of tuples, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc");
+}
@@ -16,6 +16,9 @@
 
 #include "VALI.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 using namespace std;
 using namespace VPF;
 using namespace chrono;
@@ -35,10 +38,12 @@ PyDecoder::PyDecoder(const string& pathToFile,
           : std::nullopt;
 
   upDecoder.reset(DecodeFrame::Make(pathToFile.c_str(), cli_iface, stream));
+  UpdateState();
 }
 
 PyDecoder::PyDecoder(py::object buffered_reader,
-                     const map<string, string>& ffmpeg_options, int gpuID) {
+                     const map<string, string>& ffmpeg_options, int gpuID,
+                     size_t read_ahead) {
   gpu_id = gpuID;
   NvDecoderClInterface cli_iface(ffmpeg_options);
   auto stream =
@@ -46,13 +51,134 @@ PyDecoder::PyDecoder(py::object buffered_reader,
           ? std::optional<CUstream>(CudaResMgr::Instance().GetStream(gpu_id))
           : std::nullopt;
 
-  upBuff.reset(new BufferedReader(buffered_reader));
+  upBuff.reset(new BufferedReader(buffered_reader, read_ahead));
+
+  /* Input is read while decoder is made. Reader takes GIL to call Python
+   * object, read-ahead ring is filled from helper thread, so GIL has to be
+   * released here.
+   */
+  py::gil_scoped_release gil_release;
   upDecoder.reset(
       DecodeFrame::Make("", cli_iface, stream, upBuff->GetAVIOContext()));
+  UpdateState();
+}
+
+PyDecoder::PyDecoder(py::buffer buffer,
+                     const map<string, string>& ffmpeg_options, int gpuID) {
+  gpu_id = gpuID;
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  auto stream =
+      gpu_id >= 0
+          ? std::optional<CUstream>(CudaResMgr::Instance().GetStream(gpu_id))
+          : std::nullopt;
+
+  upMem.reset(new MemoryReader(buffer));
+  upDecoder.reset(
+      DecodeFrame::Make("", cli_iface, stream, upMem->GetAVIOContext()));
+  UpdateState();
+}
+
+PyDecoder::PyDecoder(int fd, const map<string, string>& ffmpeg_options,
+                     int gpuID) {
+  gpu_id = gpuID;
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  auto stream =
+      gpu_id >= 0
+          ? std::optional<CUstream>(CudaResMgr::Instance().GetStream(gpu_id))
+          : std::nullopt;
+
+  upMem.reset(new MemoryReader(fd));
+  upDecoder.reset(
+      DecodeFrame::Make("", cli_iface, stream, upMem->GetAVIOContext()));
+  UpdateState();
+}
+
+PyDecoder::PyDecoder(const StreamParams& params,
+                     const map<string, string>& ffmpeg_options, int gpuID) {
+  gpu_id = gpuID;
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  auto stream =
+      gpu_id >= 0
+          ? std::optional<CUstream>(CudaResMgr::Instance().GetStream(gpu_id))
+          : std::nullopt;
+
+  upDecoder.reset(DecodeFrame::Make(params, cli_iface, stream));
+  UpdateState();
+}
+
+PyDecoder::~PyDecoder() {
+  // Prefetch thread may be waiting for GIL to read from Python object.
+  if (upPrefetcher && PyGILState_Check()) {
+    py::gil_scoped_release gil_release;
+    upPrefetcher.reset();
+  }
+}
+
+bool PyDecoder::DecodePacket(py::array& frame, const uint8_t* packet,
+                             size_t packet_size, std::optional<int64_t> pts,
+                             TaskExecDetails& details, PacketData& pkt_data) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!upDecoder->IsStandalone()) {
+    details = TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::NOT_SUPPORTED,
+                              "decoder reads packets from its input");
+    return false;
+  }
+
+  if (upDecoder->IsAccelerated()) {
+    details = TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::NOT_SUPPORTED,
+                              "only decoder without HW acceleration supported");
+    return false;
+  }
+
+  PacketData in_pkt_data = {};
+  in_pkt_data.pts = pts.value_or(AV_NOPTS_VALUE);
+  in_pkt_data.dts = AV_NOPTS_VALUE;
+
+  auto pkt_buf = packet ? std::shared_ptr<Buffer>(Buffer::Make(
+                              packet_size, const_cast<uint8_t*>(packet)))
+                        : nullptr;
+  auto pkt_data_buf = std::shared_ptr<Buffer>(
+      Buffer::Make(sizeof(in_pkt_data), static_cast<void*>(&in_pkt_data)));
+
+  /* Frame size isn't known until first frame is decoded. In that case and
+   * upon resolution change decoder stashes the frame and returns it upon
+   * next call which has no packet.
+   */
+  do {
+    auto const frame_size = upDecoder->GetHostFrameSize();
+    if (frame_size != frame.nbytes()) {
+      frame.resize({frame_size}, false);
+    }
+
+    auto dst = std::shared_ptr<Buffer>(
+        Buffer::Make(frame.nbytes(), frame.mutable_data()));
+
+    upDecoder->ClearInputs();
+    upDecoder->ClearOutputs();
+    upDecoder->SetInput(dst.get(), 0U);
+    if (pkt_buf) {
+      upDecoder->SetInput(pkt_buf.get(), 2U);
+      upDecoder->SetInput(pkt_data_buf.get(), 3U);
+    }
+
+    details = upDecoder->Execute();
+    pkt_buf.reset();
+  } while (TASK_EXEC_SUCCESS == details.m_status &&
+           TaskExecInfo::RES_CHANGE == details.m_info);
+
+  pkt_data = upDecoder->GetLastPacketData();
+  UpdateState();
+  return (TASK_EXEC_SUCCESS == details.m_status);
 }
 
 bool PyDecoder::DecodeImpl(TaskExecDetails& details, PacketData& pkt_data,
                            Token& dst, std::optional<SeekContext> seek_ctx) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return DecodeLocked(details, pkt_data, dst, seek_ctx);
+}
+
+bool PyDecoder::DecodeLocked(TaskExecDetails& details, PacketData& pkt_data,
+                             Token& dst, std::optional<SeekContext> seek_ctx) {
   upDecoder->ClearInputs();
   upDecoder->ClearOutputs();
   upDecoder->SetInput(&dst, 0U);
@@ -78,7 +204,24 @@ bool PyDecoder::DecodeSingleFrame(py::array& frame, TaskExecDetails& details,
     return false;
   }
 
-  auto const frame_size = upDecoder->GetHostFrameSize();
+  if (upPrefetcher) {
+    if (!seek_ctx) {
+      details = upPrefetcher->Pop(frame, pkt_data);
+      return (TASK_EXEC_SUCCESS == details.m_status);
+    }
+
+    /* Frames in the ring were decoded before the seek and are no longer
+     * valid. Stop the prefetch thread, seek synchronously and start over.
+     */
+    auto const num_frames = upPrefetcher->Capacity();
+    auto const live = IsLive();
+    upPrefetcher.reset();
+    auto const ret = DecodeSingleFrame(frame, details, pkt_data, seek_ctx);
+    StartPrefetch(num_frames, live);
+    return ret;
+  }
+
+  size_t frame_size = HostFrameSize();
   if (frame_size != frame.nbytes()) {
     frame.resize({frame_size}, false);
   }
@@ -88,6 +231,277 @@ bool PyDecoder::DecodeSingleFrame(py::array& frame, TaskExecDetails& details,
   return DecodeImpl(details, pkt_data, *dst.get(), seek_ctx);
 }
 
+bool PyDecoder::DecodeSingleFrame(HostFrame& frame, TaskExecDetails& details,
+                                  PacketData& pkt_data,
+                                  std::optional<SeekContext> seek_ctx) {
+  if (IsAccelerated()) {
+    return false;
+  }
+
+  /* Prefetched frames are already copied to ring buffers, there's nothing
+   * to reference.
+   */
+  if (upPrefetcher) {
+    details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                              TaskExecInfo::NOT_SUPPORTED,
+                              "HostFrame can't be used with prefetch");
+    return false;
+  }
+
+  return DecodeImpl(details, pkt_data, frame, seek_ctx);
+}
+
+size_t PyDecoder::DecodeBatch(size_t num_frames, size_t frame_size,
+                              uint8_t* frames, int64_t* pkt_info,
+                              TaskExecDetails& details) {
+  details = TaskExecDetails();
+  if (IsAccelerated()) {
+    details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                              TaskExecInfo::NOT_SUPPORTED,
+                              "batch decode requires decoder without HW "
+                              "acceleration");
+    return 0U;
+  }
+
+  auto save_pkt_info = [&](size_t n, const PacketData& pkt_data) {
+    pkt_info[n * 3U + 0U] = pkt_data.pts;
+    pkt_info[n * 3U + 1U] = pkt_data.dts;
+    pkt_info[n * 3U + 2U] = pkt_data.key;
+  };
+
+  PacketData pkt_data = {};
+  size_t n = 0U;
+
+  if (upPrefetcher) {
+    for (; n < num_frames; n++) {
+      details = upPrefetcher->Pop(frames + n * frame_size, frame_size,
+                                  pkt_data);
+      if (details.m_status != TASK_EXEC_SUCCESS ||
+          details.m_info != TaskExecInfo::SUCCESS) {
+        break;
+      }
+      save_pkt_info(n, pkt_data);
+    }
+    return n;
+  }
+
+  /* Whole batch is decoded under single lock with single dst Buffer which
+   * is pointed to next frame upon every iteration.
+   */
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto dst = std::shared_ptr<Buffer>(Buffer::Make(frame_size, frames));
+
+  for (; n < num_frames; n++) {
+    if (upDecoder->GetHostFrameSize() != frame_size) {
+      details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                                TaskExecInfo::SRC_DST_SIZE_MISMATCH,
+                                "frame size mismatch");
+      break;
+    }
+
+    dst->Update(frame_size, frames + n * frame_size);
+    DecodeLocked(details, pkt_data, *dst.get(), std::nullopt);
+
+    // Resolution change doesn't output pixels, so it ends the batch too.
+    if (details.m_status != TASK_EXEC_SUCCESS ||
+        details.m_info != TaskExecInfo::SUCCESS) {
+      break;
+    }
+    save_pkt_info(n, pkt_data);
+  }
+
+  return n;
+}
+
+bool PyDecoder::DecodeFrames(const std::vector<int64_t>& frame_nums,
+                             size_t frame_size, uint8_t* frames,
+                             int64_t* pkt_info, TaskExecDetails& details) {
+  details = TaskExecDetails();
+  if (IsAccelerated()) {
+    details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                              TaskExecInfo::NOT_SUPPORTED,
+                              "frames decode requires decoder without HW "
+                              "acceleration");
+    return false;
+  }
+
+  // Frames in the ring are no longer valid after seek.
+  auto const num_prefetch = GetPrefetch();
+  auto const live = IsLive();
+  upPrefetcher.reset();
+
+  /* Visit frames in ascending order. Seek to every next frame within the
+   * same GOP will decode forward instead of going back to key frame.
+   */
+  std::vector<size_t> order(frame_nums.size());
+  std::iota(order.begin(), order.end(), 0U);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return frame_nums[a] < frame_nums[b];
+  });
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto dst = std::shared_ptr<Buffer>(Buffer::Make(frame_size, frames));
+    PacketData pkt_data = {};
+
+    for (size_t i = 0U; i < order.size(); i++) {
+      auto const n = order[i];
+      auto const p_frame = frames + n * frame_size;
+
+      // Same frame requested more than once.
+      if (i > 0U && frame_nums[order[i - 1]] == frame_nums[n]) {
+        auto const prev = order[i - 1];
+        memcpy(p_frame, frames + prev * frame_size, frame_size);
+        memcpy(pkt_info + n * 3U, pkt_info + prev * 3U, 3U * sizeof(int64_t));
+        continue;
+      }
+
+      if (upDecoder->GetHostFrameSize() != frame_size) {
+        details = TaskExecDetails(TaskExecStatus::TASK_EXEC_FAIL,
+                                  TaskExecInfo::SRC_DST_SIZE_MISMATCH,
+                                  "frame size mismatch");
+        break;
+      }
+
+      dst->Update(frame_size, p_frame);
+      DecodeLocked(details, pkt_data, *dst.get(), SeekContext(frame_nums[n]));
+      if (details.m_status != TASK_EXEC_SUCCESS ||
+          details.m_info != TaskExecInfo::SUCCESS) {
+        break;
+      }
+
+      pkt_info[n * 3U + 0U] = pkt_data.pts;
+      pkt_info[n * 3U + 1U] = pkt_data.dts;
+      pkt_info[n * 3U + 2U] = pkt_data.key;
+    }
+  }
+
+  StartPrefetch(num_prefetch, live);
+  return (TASK_EXEC_SUCCESS == details.m_status &&
+          TaskExecInfo::SUCCESS == details.m_info);
+}
+
+void PyDecoder::SetPrefetch(size_t num_frames) {
+  StartPrefetch(num_frames, false);
+}
+
+void PyDecoder::SetLiveMode(size_t num_frames) {
+  if (!num_frames) {
+    throw std::invalid_argument("Live mode needs at least one frame");
+  }
+
+  if (IsAccelerated()) {
+    throw std::runtime_error(
+        "Live mode is only supported by decoder without HW acceleration");
+  }
+
+  /* Low delay reopens codec, so it's rejected once decoding has started.
+   * Prefetch is restored in that case.
+   */
+  auto const num_prefetch = GetPrefetch();
+  auto const live = IsLive();
+  upPrefetcher.reset();
+  try {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    upDecoder->SetLowDelay();
+    UpdateState();
+  } catch (...) {
+    StartPrefetch(num_prefetch, live);
+    throw;
+  }
+  StartPrefetch(num_frames, true);
+}
+
+bool PyDecoder::IsLive() const {
+  return upPrefetcher && upPrefetcher->IsDropOldest();
+}
+
+uint64_t PyDecoder::NumDropped() const { return m_num_dropped; }
+
+void PyDecoder::StartPrefetch(size_t num_frames, bool drop_oldest) {
+  upPrefetcher.reset();
+  if (!num_frames) {
+    return;
+  }
+
+  if (IsAccelerated()) {
+    throw std::runtime_error(
+        "Prefetch is only supported by decoder without HW acceleration");
+  }
+
+  if (upDecoder->IsStandalone()) {
+    throw std::runtime_error("Prefetch isn't supported by standalone decoder");
+  }
+
+  auto decode_func = [this](std::vector<uint8_t>& frame,
+                            PacketData& pkt_data) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      frame.resize(upDecoder->GetHostFrameSize());
+    }
+
+    TaskExecDetails details;
+    auto dst =
+        std::shared_ptr<Buffer>(Buffer::Make(frame.size(), frame.data()));
+    DecodeImpl(details, pkt_data, *dst.get(), std::nullopt);
+    return details;
+  };
+
+  FramePrefetcher::DropFunc drop_func = nullptr;
+  if (drop_oldest) {
+    drop_func = [this]() { m_num_dropped++; };
+  }
+
+  upPrefetcher =
+      std::make_unique<FramePrefetcher>(num_frames, decode_func, drop_func);
+}
+
+size_t PyDecoder::GetPrefetch() const {
+  return upPrefetcher ? upPrefetcher->Capacity() : 0U;
+}
+
+void PyDecoder::BuildIndex(const std::string& path) {
+  // Decoder is rewound, so frames in the ring are no longer valid.
+  auto const num_frames = GetPrefetch();
+  auto const live = IsLive();
+  upPrefetcher.reset();
+
+  TaskExecDetails details;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    details = upDecoder->BuildIndex();
+    UpdateState();
+  }
+  StartPrefetch(num_frames, live);
+
+  if (TASK_EXEC_SUCCESS != details.m_status) {
+    throw std::runtime_error("Failed to build packet index: " + details.m_msg);
+  }
+
+  if (!path.empty()) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    upDecoder->GetIndex()->Save(path);
+  }
+}
+
+void PyDecoder::LoadIndex(const std::string& path) {
+  auto index = std::shared_ptr<PacketIndex>(PacketIndex::Load(path));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  upDecoder->SetIndex(index);
+  UpdateState();
+}
+
+void PyDecoder::SetMode(DecodeMode mode) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  upDecoder->SetMode(mode);
+}
+
+DecodeMode PyDecoder::GetMode() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return upDecoder->GetMode();
+}
+
 bool PyDecoder::DecodeSingleSurface(Surface& surf, TaskExecDetails& details,
                                     PacketData& pkt_data,
                                     std::optional<SeekContext> seek_ctx) {
@@ -116,6 +530,7 @@ bool PyDecoder::DecodeSingleSurface(Surface& surf, TaskExecDetails& details,
 }
 
 void* PyDecoder::GetSideData(AVFrameSideDataType data_type, size_t& raw_size) {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (TASK_EXEC_SUCCESS == upDecoder->GetSideData(data_type).m_status) {
     auto pSideData = (Buffer*)upDecoder->GetOutput(0U);
     if (pSideData) {
@@ -127,8 +542,26 @@ void* PyDecoder::GetSideData(AVFrameSideDataType data_type, size_t& raw_size) {
 }
 
 void PyDecoder::UpdateState() {
-  last_h = Height();
-  last_w = Width();
+  // Called from ctor or with decoder lock acquired.
+  auto params = upDecoder->GetParamsSnapshot();
+  last_h = params->videoContext.height;
+  last_w = params->videoContext.width;
+  m_is_accelerated = upDecoder->IsAccelerated();
+
+  std::lock_guard<std::mutex> lock(m_params_mutex);
+  m_params = params;
+}
+
+std::shared_ptr<const MuxingParams> PyDecoder::GetParams() const {
+  std::lock_guard<std::mutex> lock(m_params_mutex);
+  return m_params;
+}
+
+VideoContext PyDecoder::Info() const { return GetParams()->videoContext; }
+
+DecoderStats PyDecoder::Stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return upDecoder->GetStats();
 }
 
 std::vector<MotionVector> PyDecoder::GetMotionVectors() {
@@ -164,138 +597,110 @@ std::vector<MotionVector> PyDecoder::GetMotionVectors() {
 }
 
 uint32_t PyDecoder::Width() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.width;
+  return GetParams()->videoContext.width;
 };
 
 uint32_t PyDecoder::Height() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.height;
+  return GetParams()->videoContext.height;
 };
 
 uint32_t PyDecoder::Level() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.level;
+  return GetParams()->videoContext.level;
 };
 
 uint32_t PyDecoder::Profile() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.profile;
+  return GetParams()->videoContext.profile;
 };
 
 uint32_t PyDecoder::Delay() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.delay;
+  return GetParams()->videoContext.delay;
 };
 
 uint32_t PyDecoder::GopSize() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.gop_size;
+  return GetParams()->videoContext.gop_size;
 };
 
 uint32_t PyDecoder::Bitrate() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.bit_rate;
+  return GetParams()->videoContext.bit_rate;
 };
 
 uint32_t PyDecoder::NumFrames() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.num_frames;
+  return GetParams()->videoContext.num_frames;
 };
 
 uint32_t PyDecoder::NumStreams() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.num_streams;
+  return GetParams()->videoContext.num_streams;
 };
 
 uint32_t PyDecoder::StreamIndex() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.stream_index;
+  return GetParams()->videoContext.stream_index;
 };
 
 uint32_t PyDecoder::HostFrameSize() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.host_frame_size;
+  return GetParams()->videoContext.host_frame_size;
 };
 
 double PyDecoder::Framerate() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.frame_rate;
+  return GetParams()->videoContext.frame_rate;
 };
 
 ColorSpace PyDecoder::Color_Space() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.color_space;
+  return GetParams()->videoContext.color_space;
 };
 
 ColorRange PyDecoder::Color_Range() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.color_range;
+  return GetParams()->videoContext.color_range;
 };
 
 double PyDecoder::AvgFramerate() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.avg_frame_rate;
+  return GetParams()->videoContext.avg_frame_rate;
 };
 
 double PyDecoder::Timebase() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.time_base;
+  return GetParams()->videoContext.time_base;
 };
 
 double PyDecoder::StartTime() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.start_time;
+  return GetParams()->videoContext.start_time;
 };
 
 double PyDecoder::Duration() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.duration;
+  return GetParams()->videoContext.duration;
 };
 
 Pixel_Format PyDecoder::PixelFormat() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.format;
+  return GetParams()->videoContext.format;
 };
 
-bool PyDecoder::IsAccelerated() const { return upDecoder->IsAccelerated(); }
+bool PyDecoder::IsAccelerated() const { return m_is_accelerated; }
 
 bool PyDecoder::IsVFR() const {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.is_vfr;
+  return GetParams()->videoContext.is_vfr;
 }
 
 std::map<std::string, std::string> PyDecoder::Metadata() {
-  MuxingParams params;
-  upDecoder->GetParams(params);
-  return params.videoContext.metadata;
+  return GetParams()->videoContext.metadata;
 }
 
 void Init_PyDecoder(py::module& m) {
   py::class_<PyDecoder, shared_ptr<PyDecoder>>(m, "PyDecoder",
                                                "Video decoder class.")
+      // Goes first, otherwise bytes are converted to file path.
+      .def(py::init<py::buffer, const map<string, string>&, int>(),
+           py::arg("buffer"), py::arg("opts"), py::arg("gpu_id") = 0,
+           R"pbdoc(
+        Constructor method.
+        Reads input from memory without copy. Unlike buffered reader, no Python
+        code is called and GIL isn't taken upon decode.
+
+        :param buffer: C-contiguous object which supports buffer protocol, e. g. bytes, memoryview or numpy array. Decoder keeps it alive, don't modify it.
+        :param opts: AVDictionary options that will be passed to AVFormat context.
+        :param gpu_id: GPU ID. Default value is 0. Pass negative value to use CPU decoder.
+    )pbdoc")
+      // Input may be pipe written to from Python, so GIL is released.
       .def(py::init<const string&, const map<string, string>&, int>(),
            py::arg("input"), py::arg("opts"), py::arg("gpu_id") = 0,
+           py::call_guard<py::gil_scoped_release>(),
            R"pbdoc(
         Constructor method.
 
@@ -303,14 +708,96 @@ void Init_PyDecoder(py::module& m) {
         :param opts: AVDictionary options that will be passed to AVFormat context.
         :param gpu_id: GPU ID. Default value is 0. Pass negative value to use CPU decoder.
     )pbdoc")
-      .def(py::init<py::object, const map<string, string>&, int>(),
+      .def(py::init<const StreamParams&, const map<string, string>&, int>(),
+           py::arg("params"), py::arg("opts"), py::arg("gpu_id") = 0,
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Constructor method.
+        Makes standalone decoder which has no input. Use DecodePacket to pass
+        compressed packets to it.
+
+        :param params: video stream parameters
+        :param opts: AVDictionary options that will be passed to codec.
+        :param gpu_id: GPU ID. Default value is 0. Pass negative value to use CPU decoder.
+    )pbdoc")
+      .def(py::init<int, const map<string, string>&, int>(), py::arg("fd"),
+           py::arg("opts"), py::arg("gpu_id") = 0,
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Constructor method.
+        Maps file to memory and reads input from there. GIL isn't taken upon
+        decode. File descriptor isn't closed by decoder.
+
+        :param fd: file descriptor of regular file, e. g. one returned by os.open()
+        :param opts: AVDictionary options that will be passed to AVFormat context.
+        :param gpu_id: GPU ID. Default value is 0. Pass negative value to use CPU decoder.
+    )pbdoc")
+      // Any object converts to py::object, so this overload goes last.
+      .def(py::init<py::object, const map<string, string>&, int, size_t>(),
            py::arg("buffered_reader"), py::arg("opts"), py::arg("gpu_id") = 0,
+           py::arg("read_ahead") = 0U,
            R"pbdoc(
         Constructor method.
 
         :param buffered_reader: io.BufferedReader object
         :param opts: AVDictionary options that will be passed to AVFormat context.
         :param gpu_id: GPU ID. Default value is 0. Pass negative value to use CPU decoder.
+        :param read_ahead: size of read-ahead ring in bytes. If not zero, helper thread reads data from buffered_reader in advance, so decoder doesn't wait for GIL. Default value is 0.
+    )pbdoc")
+      .def(
+          "DecodePacket",
+          [](PyDecoder& self, py::array& frame,
+             std::optional<py::array_t<uint8_t, py::array::c_style>>& packet,
+             std::optional<int64_t> pts) {
+            TaskExecDetails details;
+            PacketData pkt_data;
+            auto p_packet = packet ? packet->data() : nullptr;
+            auto const packet_size = packet ? (size_t)packet->nbytes() : 0U;
+
+            return std::make_tuple(self.DecodePacket(frame, p_packet,
+                                                     packet_size, pts, details,
+                                                     pkt_data),
+                                   details.m_info);
+          },
+          py::arg("frame"), py::arg("packet"), py::arg("pts") = std::nullopt,
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Pass compressed packet to standalone decoder and get single frame.
+        Decoder may need few packets before it outputs first frame, so
+        MORE_DATA_NEEDED isn't an error. Once all packets are passed, call
+        this method with None packet until it returns END_OF_STREAM to get
+        remaining frames. Only call this method for decoder without HW
+        acceleration.
+
+        :param frame: decoded video frame
+        :param packet: compressed packet, e. g. one returned by PyDemuxer. None to flush decoder.
+        :param pts: packet presentation timestamp in stream time base units, may be None
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def(
+          "DecodePacket",
+          [](PyDecoder& self, py::array& frame,
+             std::optional<py::array_t<uint8_t, py::array::c_style>>& packet,
+             std::optional<int64_t> pts, PacketData& pkt_data) {
+            TaskExecDetails details;
+            auto p_packet = packet ? packet->data() : nullptr;
+            auto const packet_size = packet ? (size_t)packet->nbytes() : 0U;
+
+            return std::make_tuple(self.DecodePacket(frame, p_packet,
+                                                     packet_size, pts, details,
+                                                     pkt_data),
+                                   details.m_info);
+          },
+          py::arg("frame"), py::arg("packet"), py::arg("pts"),
+          py::arg("pkt_data"), py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Pass compressed packet to standalone decoder and get single frame.
+
+        :param frame: decoded video frame
+        :param packet: compressed packet, e. g. one returned by PyDemuxer. None to flush decoder.
+        :param pts: packet presentation timestamp in stream time base units, may be None
+        :param pkt_data: decoded video frame packet data
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
     )pbdoc")
       .def(
           "DecodeSingleFrame",
@@ -356,6 +843,53 @@ void Init_PyDecoder(py::module& m) {
         :param seek_ctx: seek context, may be None
         :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
     )pbdoc")
+      .def(
+          "DecodeSingleFrame",
+          [](PyDecoder& self, HostFrame& frame,
+             std::optional<SeekContext>& seek_ctx) {
+            TaskExecDetails details;
+            PacketData pkt_data;
+
+            return std::make_tuple(
+                self.DecodeSingleFrame(frame, details, pkt_data, seek_ctx),
+                details.m_info);
+          },
+          py::arg("frame"), py::arg("seek_ctx") = std::nullopt,
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Decode single video frame from input file without copy.
+        Frame will reference decoder memory, its planes support buffer protocol
+        and DLPack. Planes obtained from frame stay valid after next decode.
+        Only call this method for decoder without HW acceleration and prefetch.
+
+        :param frame: decoded video frame
+        :param seek_ctx: seek context, may be None
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def(
+          "DecodeSingleFrame",
+          [](PyDecoder& self, HostFrame& frame, PacketData& pkt_data,
+             std::optional<SeekContext>& seek_ctx) {
+            TaskExecDetails details;
+
+            return std::make_tuple(
+                self.DecodeSingleFrame(frame, details, pkt_data, seek_ctx),
+                details.m_info);
+          },
+          py::arg("frame"), py::arg("pkt_data"),
+          py::arg("seek_ctx") = std::nullopt,
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Decode single video frame from input file without copy.
+        Frame will reference decoder memory, its planes support buffer protocol
+        and DLPack. Planes obtained from frame stay valid after next decode.
+        Only call this method for decoder without HW acceleration and prefetch.
+
+        :param frame: decoded video frame
+        :param pkt_data: decoded video frame packet data, may be None
+        :param seek_ctx: seek context, may be None
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
       .def(
           "DecodeSingleSurface",
           [](PyDecoder& self, Surface& surf,
@@ -399,6 +933,199 @@ void Init_PyDecoder(py::module& m) {
         :param pkt_data: decoded video surface packet data, may be None
         :param seek_ctx: seek context, may be None
         :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def(
+          "DecodeBatch",
+          [](PyDecoder& self, size_t num_frames, py::array& frames,
+             py::array& pkt_info) {
+            if (!frames.dtype().is(py::dtype::of<uint8_t>()) ||
+                !pkt_info.dtype().is(py::dtype::of<int64_t>())) {
+              throw std::invalid_argument(
+                  "frames must be uint8 array, pkt_info must be int64 array");
+            }
+
+            // Arrays are resized with GIL held, decoding is done without it.
+            auto const frame_size = (size_t)self.HostFrameSize();
+            if (frames.ndim() != 2 || (size_t)frames.shape(0) != num_frames ||
+                (size_t)frames.shape(1) != frame_size) {
+              frames.resize({num_frames, frame_size}, false);
+            }
+
+            if (pkt_info.ndim() != 2 ||
+                (size_t)pkt_info.shape(0) != num_frames ||
+                pkt_info.shape(1) != 3) {
+              pkt_info.resize({num_frames, (size_t)3U}, false);
+            }
+
+            auto p_frames = static_cast<uint8_t*>(frames.mutable_data());
+            auto p_pkt_info = static_cast<int64_t*>(pkt_info.mutable_data());
+
+            TaskExecDetails details;
+            size_t num_decoded = 0U;
+            {
+              py::gil_scoped_release gil_release;
+              num_decoded = self.DecodeBatch(num_frames, frame_size, p_frames,
+                                             p_pkt_info, details);
+            }
+
+            return std::make_tuple(num_decoded, details.m_info);
+          },
+          py::arg("num_frames"), py::arg("frames"), py::arg("pkt_info"),
+          R"pbdoc(
+        Decode batch of video frames from input file in a single call.
+        Frames are stored in contiguous uint8 array of shape
+        [num_frames, HostFrameSize], packet pts, dts and key flag of every
+        frame are stored in int64 array of shape [num_frames, 3].
+        Both arrays are resized if their shape doesn't match.
+        Decoding stops at the end of stream, error or resolution change.
+        Only call this method for decoder without HW acceleration.
+
+        :param num_frames: number of frames to decode
+        :param frames: decoded video frames
+        :param pkt_info: pts, dts and key flag of decoded video frames
+        :return: tuple, first element is number of decoded frames. Second element is TaskExecInfo of the last decode call.
+    )pbdoc")
+      .def(
+          "DecodeFrames",
+          [](PyDecoder& self, const std::vector<int64_t>& frame_nums,
+             py::array& frames, py::array& pkt_info) {
+            if (!frames.dtype().is(py::dtype::of<uint8_t>()) ||
+                !pkt_info.dtype().is(py::dtype::of<int64_t>())) {
+              throw std::invalid_argument(
+                  "frames must be uint8 array, pkt_info must be int64 array");
+            }
+
+            for (auto frame_num : frame_nums) {
+              if (frame_num < 0) {
+                throw std::invalid_argument("Negative frame number");
+              }
+            }
+
+            // Arrays are resized with GIL held, decoding is done without it.
+            auto const num_frames = frame_nums.size();
+            auto const frame_size = (size_t)self.HostFrameSize();
+            if (frames.ndim() != 2 || (size_t)frames.shape(0) != num_frames ||
+                (size_t)frames.shape(1) != frame_size) {
+              frames.resize({num_frames, frame_size}, false);
+            }
+
+            if (pkt_info.ndim() != 2 ||
+                (size_t)pkt_info.shape(0) != num_frames ||
+                pkt_info.shape(1) != 3) {
+              pkt_info.resize({num_frames, (size_t)3U}, false);
+            }
+
+            auto p_frames = static_cast<uint8_t*>(frames.mutable_data());
+            auto p_pkt_info = static_cast<int64_t*>(pkt_info.mutable_data());
+
+            TaskExecDetails details;
+            auto success = false;
+            {
+              py::gil_scoped_release gil_release;
+              success = self.DecodeFrames(frame_nums, frame_size, p_frames,
+                                          p_pkt_info, details);
+            }
+
+            return std::make_tuple(success, details.m_info);
+          },
+          py::arg("frame_nums"), py::arg("frames"), py::arg("pkt_info"),
+          R"pbdoc(
+        Decode video frames with given numbers in a single call.
+        Numbers may go in any order and repeat. Frames are decoded in
+        ascending order, decoder seeks once per GOP and decodes forward up to
+        the last requested frame in it. Build or load packet index for
+        precise GOP boundaries, it's also required for VFR videos.
+        Frames are stored in contiguous uint8 array of shape
+        [len(frame_nums), HostFrameSize] in the same order as numbers are
+        given, packet pts, dts and key flag of every frame are stored in int64
+        array of shape [len(frame_nums), 3].
+        Both arrays are resized if their shape doesn't match.
+        Only call this method for decoder without HW acceleration.
+
+        :param frame_nums: numbers of frames to decode
+        :param frames: decoded video frames
+        :param pkt_info: pts, dts and key flag of decoded video frames
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def("SetPrefetch", &PyDecoder::SetPrefetch, py::arg("num_frames"),
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Enable or disable background decoding.
+        Decoder will run in a separate thread and keep up to given number of
+        decoded frames in a ring of preallocated host buffers.
+        DecodeSingleFrame will then return next frame from the ring.
+        Seek will stop background thread, drop decoded frames and restart
+        prefetch after seek is done.
+        Only call this method for decoder without HW acceleration.
+
+        :param num_frames: number of frames to prefetch. Pass 0 to disable.
+    )pbdoc")
+      .def("SetLiveMode", &PyDecoder::SetLiveMode, py::arg("num_frames") = 1,
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Enable live mode for RTSP, UDP, HTTP and other live sources.
+        Decoder will run in a separate thread same way it does with prefetch,
+        but it never waits for the ring to be popped. When ring is full,
+        oldest frame is dropped, so DecodeSingleFrame returns one of the most
+        recent frames and latency doesn't grow if consumer is slower than the
+        source. Number of dropped frames is returned by NumDropped.
+        Demuxer buffering and codec frame threading are disabled to reduce
+        latency, codec is reopened, so call this method before decoding.
+        RuntimeError is raised if it's called after decoding has started,
+        prefetch stays as it was then. Live mode is disabled by SetPrefetch.
+        Only call this method for decoder without HW acceleration.
+
+        :param num_frames: number of the most recent frames to keep.
+    )pbdoc")
+      .def("BuildIndex", &PyDecoder::BuildIndex, py::arg("path") = "",
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Read all video packets without decoding and build packet index.
+        Index stores timestamps of every frame and position of key frames.
+        Seek uses it to jump to the exact preceding key frame, so seek by
+        frame number is supported for VFR videos as well.
+        Decoder is rewound to the beginning of the video.
+
+        :param path: path to index file to save the index to. Index isn't saved if empty.
+    )pbdoc")
+      .def("LoadIndex", &PyDecoder::LoadIndex, py::arg("path"),
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Load packet index saved by BuildIndex.
+        Index file is memory mapped, it's not parsed upon load.
+
+        :param path: path to index file
+    )pbdoc")
+      .def("SetMode", &PyDecoder::SetMode, py::arg("mode"),
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Set decode mode.
+        In KEY_FRAMES mode non-key packets are dropped right after they are
+        read from input, so only key frames are decoded and returned. Seek
+        then returns the first key frame which isn't located before the
+        target. Frames already prefetched in background aren't dropped.
+        Mode change takes effect starting from the next packet, so seek is
+        advised after switching back to FULL mode.
+
+        :param mode: decode mode
+    )pbdoc")
+      .def_property_readonly("Mode", &PyDecoder::GetMode,
+                             py::call_guard<py::gil_scoped_release>(),
+                             R"pbdoc(
+        Return decode mode.
+    )pbdoc")
+      .def_property_readonly("Prefetch", &PyDecoder::GetPrefetch,
+                             R"pbdoc(
+        Return number of frames decoder prefetches in background, 0 if prefetch
+        is disabled.
+    )pbdoc")
+      .def_property_readonly("IsLive", &PyDecoder::IsLive,
+                             R"pbdoc(
+        Return True if live mode is enabled, False otherwise.
+    )pbdoc")
+      .def_property_readonly("NumDropped", &PyDecoder::NumDropped,
+                             R"pbdoc(
+        Return number of frames dropped in live mode.
     )pbdoc")
       .def_property_readonly("Width", &PyDecoder::Width,
                              R"pbdoc(
@@ -504,6 +1231,24 @@ void Init_PyDecoder(py::module& m) {
       .def_property_readonly("Metadata", &PyDecoder::Metadata,
                              R"pbdoc(
         Return dictionary with video file metadata.
+    )pbdoc")
+      .def_property_readonly("Info", &PyDecoder::Info,
+                             R"pbdoc(
+        Return all stream parameters at once. Use it instead of separate
+        properties when several of them are needed.
+        Parameters are cached by decoder and only updated upon resolution
+        change, so it's cheap to call per frame.
+    )pbdoc")
+      .def("Stats", &PyDecoder::Stats, py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Return decoder statistics: packets and frames counters, number of
+        codec reopens, bytes read and wall time spent on demuxing, sending
+        packets to decoder, receiving frames from it, copying decoded frames
+        and seeking.
+        Compare stages total time to tell if decoding is I/O, decode or copy
+        bound.
+
+        :return: DecoderStats object.
     )pbdoc");
 
   m.attr("NO_PTS") = py::int_(AV_NOPTS_VALUE);
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+#include "Utils.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+using namespace std;
+using namespace VPF;
+
+namespace py = pybind11;
+
+constexpr auto TASK_EXEC_SUCCESS = TaskExecStatus::TASK_EXEC_SUCCESS;
+
+PyDemuxer::PyDemuxer(const string& pathToFile,
+                     const map<string, string>& ffmpeg_options) {
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  upDemuxer.reset(DemuxFrame::Make(pathToFile.c_str(), cli_iface));
+}
+
+PyDemuxer::PyDemuxer(py::object buffered_reader,
+                     const map<string, string>& ffmpeg_options) {
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  upBuff.reset(new BufferedReader(buffered_reader));
+  upDemuxer.reset(DemuxFrame::Make("", cli_iface, upBuff->GetAVIOContext()));
+}
+
+bool PyDemuxer::DemuxSinglePacket(std::shared_ptr<AVPacket>& pkt,
+                                  TaskExecDetails& details,
+                                  PacketData& pkt_data) {
+  details = upDemuxer->Execute();
+  if (TASK_EXEC_SUCCESS != details.m_status) {
+    return false;
+  }
+
+  pkt = upDemuxer->GetLastPacket();
+  pkt_data = upDemuxer->GetLastPacketData();
+  return true;
+}
+
+const StreamParams& PyDemuxer::GetStreamParams() const {
+  return upDemuxer->GetStreamParams();
+}
+
+int PyDemuxer::StreamIndex() const { return upDemuxer->GetStreamIndex(); }
+
+int PyDemuxer::NumStreams() const { return upDemuxer->GetNumStreams(); }
+
+py::array MakePacketArray(std::shared_ptr<AVPacket> pkt) {
+  auto const size = (size_t)pkt->size;
+  auto data = pkt->data;
+
+  // Capsule owns packet reference, array keeps capsule alive.
+  auto owner = new std::shared_ptr<AVPacket>(std::move(pkt));
+  auto capsule = py::capsule(owner, [](void* p) {
+    delete static_cast<std::shared_ptr<AVPacket>*>(p);
+  });
+
+  auto array = py::array_t<uint8_t>((py::ssize_t)size, data, capsule);
+
+  // Packet buffer may be shared with other references, so don't modify it.
+  array.attr("setflags")(py::arg("write") = false);
+  return array;
+}
+
+void Init_PyDemuxer(py::module& m) {
+  py::class_<StreamParams, shared_ptr<StreamParams>>(
+      m, "StreamParams", "Video stream codec parameters and time base.")
+      .def(py::init([](const std::string& codec, int width, int height,
+                       py::bytes extradata, std::pair<int, int> time_base) {
+             auto const data = std::string(extradata);
+             return std::make_shared<StreamParams>(StreamParams::Make(
+                 codec, width, height,
+                 std::vector<uint8_t>(data.begin(), data.end()),
+                 {time_base.first, time_base.second}));
+           }),
+           py::arg("codec"), py::arg("width"), py::arg("height"),
+           py::arg("extradata") = py::bytes(),
+           py::arg("time_base") = std::make_pair(1, 90000),
+           R"pbdoc(
+        Constructor method.
+        Use it to set up standalone decoder for packets which don't come
+        from PyDemuxer.
+
+        :param codec: codec name, e. g. h264 or hevc
+        :param width: video width in pixels
+        :param height: video height in pixels
+        :param extradata: codec extradata, e. g. SPS and PPS. May be empty for Annex B bitstream.
+        :param time_base: stream time base as (numerator, denominator) tuple
+    )pbdoc")
+      .def_property_readonly(
+          "Codec",
+          [](const StreamParams& self) {
+            return std::string(avcodec_get_name(self.codec_params->codec_id));
+          },
+          R"pbdoc(
+        Return codec name.
+    )pbdoc")
+      .def_property_readonly(
+          "Width",
+          [](const StreamParams& self) { return self.codec_params->width; },
+          R"pbdoc(
+        Return video width in pixels.
+    )pbdoc")
+      .def_property_readonly(
+          "Height",
+          [](const StreamParams& self) { return self.codec_params->height; },
+          R"pbdoc(
+        Return video height in pixels.
+    )pbdoc")
+      .def_property_readonly(
+          "Format",
+          [](const StreamParams& self) {
+            return fromFfmpegPixelFormat(
+                (AVPixelFormat)self.codec_params->format);
+          },
+          R"pbdoc(
+        Return pixel format of decoded frames.
+    )pbdoc")
+      .def_property_readonly(
+          "Timebase",
+          [](const StreamParams& self) { return av_q2d(self.time_base); },
+          R"pbdoc(
+        Return stream time base in seconds.
+    )pbdoc")
+      .def_property_readonly(
+          "Extradata",
+          [](const StreamParams& self) {
+            auto const& par = self.codec_params;
+            return py::bytes(reinterpret_cast<const char*>(par->extradata),
+                             par->extradata_size);
+          },
+          R"pbdoc(
+        Return codec extradata, e. g. SPS and PPS for H.264 in AVCC format.
+    )pbdoc");
+
+  py::class_<PyDemuxer, shared_ptr<PyDemuxer>>(
+      m, "PyDemuxer", "Video demuxer class. Reads packets without decoding.")
+      .def(py::init<const string&, const map<string, string>&>(),
+           py::arg("input"), py::arg("opts"),
+           R"pbdoc(
+        Constructor method.
+
+        :param input: path to input file
+        :param opts: AVDictionary options that will be passed to AVFormat context.
+    )pbdoc")
+      .def(py::init<py::object, const map<string, string>&>(),
+           py::arg("buffered_reader"), py::arg("opts"),
+           R"pbdoc(
+        Constructor method.
+
+        :param buffered_reader: io.BufferedReader object
+        :param opts: AVDictionary options that will be passed to AVFormat context.
+    )pbdoc")
+      .def(
+          "DemuxSinglePacket",
+          [](PyDemuxer& self, PacketData& pkt_data) {
+            TaskExecDetails details;
+            std::shared_ptr<AVPacket> pkt;
+            {
+              py::gil_scoped_release gil_release;
+              if (!self.DemuxSinglePacket(pkt, details, pkt_data)) {
+                pkt.reset();
+              }
+            }
+
+            py::object packet = pkt ? MakePacketArray(pkt) : py::none();
+            return std::make_tuple(packet, details.m_info);
+          },
+          py::arg("pkt_data"),
+          R"pbdoc(
+        Read next video packet.
+        Packets of other streams are skipped. Packet data isn't copied, it's
+        returned as read-only numpy array which shares memory with demuxer.
+
+        :param pkt_data: packet data
+        :return: tuple, first element is packet or None in case of failure. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def(
+          "DemuxSinglePacket",
+          [](PyDemuxer& self) {
+            TaskExecDetails details;
+            PacketData pkt_data;
+            std::shared_ptr<AVPacket> pkt;
+            {
+              py::gil_scoped_release gil_release;
+              if (!self.DemuxSinglePacket(pkt, details, pkt_data)) {
+                pkt.reset();
+              }
+            }
+
+            py::object packet = pkt ? MakePacketArray(pkt) : py::none();
+            return std::make_tuple(packet, details.m_info);
+          },
+          R"pbdoc(
+        Read next video packet.
+        Packets of other streams are skipped. Packet data isn't copied, it's
+        returned as read-only numpy array which shares memory with demuxer.
+
+        :return: tuple, first element is packet or None in case of failure. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def_property_readonly("StreamParams", &PyDemuxer::GetStreamParams,
+                             py::return_value_policy::copy,
+                             R"pbdoc(
+        Return video stream parameters. Pass them to decoder or muxer.
+    )pbdoc")
+      .def_property_readonly("StreamIndex", &PyDemuxer::StreamIndex,
+                             R"pbdoc(
+        Return index of video stream in the input.
+    )pbdoc")
+      .def_property_readonly("NumStreams", &PyDemuxer::NumStreams,
+                             R"pbdoc(
+        Return number of streams in the input.
+    )pbdoc");
+}
@@ -21,9 +21,21 @@ namespace py = pybind11;
 PyFrameConverter::PyFrameConverter(uint32_t width, uint32_t height,
                                    Pixel_Format inFormat,
                                    Pixel_Format outFormat)
-    : m_width(width), m_height(height), m_src_fmt(inFormat),
+    : PyFrameConverter(width, height, width, height, inFormat, outFormat,
+                       ScalingAlgorithm::BILINEAR, 1U) {}
+
+PyFrameConverter::PyFrameConverter(uint32_t src_width, uint32_t src_height,
+                                   uint32_t dst_width, uint32_t dst_height,
+                                   Pixel_Format inFormat,
+                                   Pixel_Format outFormat,
+                                   ScalingAlgorithm algorithm,
+                                   uint32_t num_threads)
+    : m_src_width(src_width), m_src_height(src_height),
+      m_dst_width(dst_width), m_dst_height(dst_height), m_src_fmt(inFormat),
       m_dst_fmt(outFormat) {
-  m_up_cvt.reset(ConvertFrame::Make(width, height, inFormat, outFormat));
+  m_up_cvt.reset(ConvertFrame::Make(src_width, src_height, dst_width,
+                                    dst_height, inFormat, outFormat,
+                                    algorithm, num_threads));
   m_up_ctx_buf.reset(Buffer::MakeOwnMem(sizeof(ColorspaceConversionContext)));
 }
 
@@ -31,16 +43,16 @@ bool PyFrameConverter::Run(py::array& src, py::array& dst,
                            std::shared_ptr<ColorspaceConversionContext> context,
                            TaskExecDetails& details) {
   auto const src_buf_size =
-      getBufferSize(m_width, m_height, toFfmpegPixelFormat(m_src_fmt));
+      getBufferSize(m_src_width, m_src_height, toFfmpegPixelFormat(m_src_fmt));
   if (src.nbytes() != src_buf_size) {
     details.m_info = TaskExecInfo::INVALID_INPUT;
     return false;
   }
 
   auto const dst_buf_size =
-      getBufferSize(m_width, m_height, toFfmpegPixelFormat(m_dst_fmt));
+      getBufferSize(m_dst_width, m_dst_height, toFfmpegPixelFormat(m_dst_fmt));
   if (dst.nbytes() != dst_buf_size) {
-    dst.resize({dst_buf_size}, false);
+    dst.resize({dst_buf_size / dst.itemsize()}, false);
   }
 
   auto src_buf = std::shared_ptr<Buffer>(
@@ -62,6 +74,11 @@ bool PyFrameConverter::Run(py::array& src, py::array& dst,
   return (details.m_status == TaskExecStatus::TASK_EXEC_SUCCESS);
 }
 
+void PyFrameConverter::SetNormalization(const std::array<float, 3>& mean,
+                                        const std::array<float, 3>& std) {
+  m_up_cvt->SetNormalization(mean, std);
+}
+
 void Init_PyFrameConverter(py::module& m) {
   py::class_<PyFrameConverter>(
       m, "PyFrameConverter",
@@ -76,6 +93,27 @@ void Init_PyFrameConverter(py::module& m) {
         :param height: target frame height
         :param src_format: input frame pixel format
         :param dst_format: output frame pixel format
+    )pbdoc")
+      .def(py::init<uint32_t, uint32_t, uint32_t, uint32_t, Pixel_Format,
+                    Pixel_Format, ScalingAlgorithm, uint32_t>(),
+           py::arg("src_width"), py::arg("src_height"), py::arg("dst_width"),
+           py::arg("dst_height"), py::arg("src_format"), py::arg("dst_format"),
+           py::arg("algorithm") = ScalingAlgorithm::BILINEAR,
+           py::arg("threads") = 1U,
+           R"pbdoc(
+        Constructor method. Converter does pixel format conversion and scaling
+        in single pass, so there's no need to convert at full resolution and
+        then resize.
+
+        :param src_width: input frame width
+        :param src_height: input frame height
+        :param dst_width: output frame width
+        :param dst_height: output frame height
+        :param src_format: input frame pixel format
+        :param dst_format: output frame pixel format
+        :param algorithm: scaling algorithm
+        :param threads: number of threads. Frame is split into horizontal
+            slices converted in parallel. 0 means one thread per CPU core.
     )pbdoc")
       .def_property_readonly("Format", &PyFrameConverter::GetFormat, R"pbdoc(
         Get pixel format.
@@ -100,5 +138,22 @@ void Init_PyFrameConverter(py::module& m) {
           success (Bool) True in case of success, False otherwise.
           info (TaskExecInfo) task execution information.
         :rtype: tuple
+    )pbdoc")
+      .def("SetNormalization", &PyFrameConverter::SetNormalization,
+           py::arg("mean"), py::arg("std"),
+           R"pbdoc(
+        Set per channel normalization of NV12 or YUV420 to RGB_32F_PLANAR
+        conversion. Output is (RGB / 255 - mean) / std, so it's ready for
+        inference without extra passes over the frame. By default output is
+        in [0; 1] range.
+
+        Conversion is done by vectorized kernel chosen at runtime instead of
+        libswscale. It doesn't scale, so normalization isn't available if
+        input and output sizes differ.
+
+        :param mean: mean value of R, G and B channels.
+        :param std: standard deviation of R, G and B channels.
+        :raises ValueError: if conversion isn't supported by the kernel or
+            std is 0.
     )pbdoc");
 }
\ No newline at end of file
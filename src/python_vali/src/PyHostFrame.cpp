@@ -0,0 +1,164 @@
+/*
+ * Copyright 2024 VisionLabs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+#include "dlpack.h"
+
+using namespace std;
+using namespace VPF;
+
+namespace py = pybind11;
+
+void dlpack_capsule_deleter(PyObject* self);
+
+static HostFramePlane GetPlane(shared_ptr<HostFrame> self, uint32_t plane) {
+  if (plane >= self->NumPlanes()) {
+    throw py::index_error("Invalid plane number");
+  }
+
+  /* Plane references snapshot of frame memory, so it's not affected by
+   * following decode calls which update the frame.
+   */
+  return HostFramePlane{shared_ptr<HostFrame>(self->Clone()), plane};
+}
+
+void Init_PyHostFrame(py::module& m) {
+  py::class_<HostFramePlane, shared_ptr<HostFramePlane>>(
+      m, "HostFramePlane", py::buffer_protocol(),
+      "Single plane of HostFrame. Supports buffer protocol and DLPack "
+      "specification, both reference decoded frame memory without copy.")
+      .def_property_readonly(
+          "Width",
+          [](HostFramePlane& self) { return self.frame->Width(self.plane); },
+          R"pbdoc(
+        Get width in elements
+    )pbdoc")
+      .def_property_readonly(
+          "Height",
+          [](HostFramePlane& self) { return self.frame->Height(self.plane); },
+          R"pbdoc(
+        Get height in pixels
+    )pbdoc")
+      .def_property_readonly(
+          "Pitch",
+          [](HostFramePlane& self) { return self.frame->Pitch(self.plane); },
+          R"pbdoc(
+        Get pitch in bytes
+    )pbdoc")
+      .def_property_readonly(
+          "ElemSize",
+          [](HostFramePlane& self) { return self.frame->ElemSize(); },
+          R"pbdoc(
+        Get element size in bytes
+    )pbdoc")
+      .def_buffer([](HostFramePlane& self) -> py::buffer_info {
+        auto& frame = *self.frame.get();
+        auto const elem_size = frame.ElemSize();
+        auto const is_float = (kDLFloat == frame.DataType());
+
+        std::string format;
+        switch (elem_size) {
+        case 1U:
+          format = py::format_descriptor<uint8_t>::format();
+          break;
+        case 2U:
+          format = py::format_descriptor<uint16_t>::format();
+          break;
+        case 4U:
+          format = is_float ? py::format_descriptor<float>::format()
+                            : py::format_descriptor<uint32_t>::format();
+          break;
+        default:
+          throw std::runtime_error("Unsupported element size");
+        }
+
+        return py::buffer_info(
+            frame.Data(self.plane), elem_size, format, 2,
+            {(py::ssize_t)frame.Height(self.plane),
+             (py::ssize_t)frame.Width(self.plane)},
+            {(py::ssize_t)frame.Pitch(self.plane), (py::ssize_t)elem_size},
+            true);
+      })
+      .def(
+          "__dlpack_device__",
+          [](HostFramePlane& self) { return std::make_tuple(kDLCPU, 0); },
+          R"pbdoc(
+        DLPack: get device information.
+    )pbdoc")
+      .def(
+          "__dlpack__",
+          [](HostFramePlane& self, int stream) {
+            auto dlmt = self.frame->ToDLPack(self.plane);
+            return py::capsule(dlmt, "dltensor", dlpack_capsule_deleter);
+          },
+          py::arg("stream") = 0,
+          R"pbdoc(
+        DLPack: get capsule.
+    )pbdoc");
+
+  py::class_<HostFrame, shared_ptr<HostFrame>>(
+      m, "HostFrame",
+      "Decoded video frame stored in RAM. Consists of 1+ HostFramePlane(s). "
+      "Pass it to PyDecoder.DecodeSingleFrame to get decoded frame without "
+      "copy.")
+      .def(py::init([]() { return shared_ptr<HostFrame>(HostFrame::Make()); }),
+           R"pbdoc(
+        Constructor method. Creates empty frame.
+    )pbdoc")
+      .def_property_readonly(
+          "Width", [](HostFrame& self) { return self.Width(0U); },
+          R"pbdoc(
+        Width in elements of plane 0.
+    )pbdoc")
+      .def_property_readonly(
+          "Height", [](HostFrame& self) { return self.Height(0U); },
+          R"pbdoc(
+        Height in pixels of plane 0.
+    )pbdoc")
+      .def_property_readonly("Format", &HostFrame::PixelFormat,
+                             R"pbdoc(
+        Get pixel format.
+    )pbdoc")
+      .def_property_readonly("NumPlanes", &HostFrame::NumPlanes,
+                             R"pbdoc(
+        Number of planes.
+    )pbdoc")
+      .def_property_readonly("HostSize", &HostFrame::HostMemSize,
+                             R"pbdoc(
+        Amount of memory in bytes which is needed to store all planes
+        without padding.
+    )pbdoc")
+      .def_property_readonly("Empty", &HostFrame::Empty,
+                             R"pbdoc(
+        Tells if frame doesn't reference any memory.
+    )pbdoc")
+      .def_property_readonly(
+          "Planes",
+          [](shared_ptr<HostFrame> self) {
+            std::vector<HostFramePlane> planes;
+            for (auto i = 0U; i < self->NumPlanes(); i++) {
+              planes.push_back(GetPlane(self, i));
+            }
+            return planes;
+          },
+          R"pbdoc(
+        Get list of frame planes.
+    )pbdoc")
+      .def("Plane", &GetPlane, py::arg("plane") = 0U,
+           R"pbdoc(
+        Get frame plane.
+
+        :param plane: plane number
+    )pbdoc");
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+
+using namespace std;
+using namespace VPF;
+
+namespace py = pybind11;
+
+constexpr auto TASK_EXEC_SUCCESS = TaskExecStatus::TASK_EXEC_SUCCESS;
+
+PyMuxer::PyMuxer(const string& pathToFile, const StreamParams& params,
+                 const map<string, string>& ffmpeg_options,
+                 const string& format, bool async) {
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  upMuxer.reset(
+      MuxFrame::Make(pathToFile.c_str(), params, cli_iface, format, async));
+}
+
+bool PyMuxer::MuxSinglePacket(const uint8_t* packet, size_t packet_size,
+                              const PacketData* pkt_data,
+                              TaskExecDetails& details) {
+  auto pkt_buf = std::shared_ptr<Buffer>(
+      Buffer::Make(packet_size, const_cast<uint8_t*>(packet)));
+
+  PacketData in_pkt_data = {};
+  if (pkt_data) {
+    in_pkt_data = *pkt_data;
+  } else {
+    in_pkt_data.pts = AV_NOPTS_VALUE;
+    in_pkt_data.dts = AV_NOPTS_VALUE;
+  }
+
+  auto pkt_data_buf = std::shared_ptr<Buffer>(
+      Buffer::Make(sizeof(in_pkt_data), static_cast<void*>(&in_pkt_data)));
+
+  upMuxer->ClearInputs();
+  upMuxer->SetInput(pkt_buf.get(), 0U);
+  upMuxer->SetInput(pkt_data_buf.get(), 1U);
+
+  details = upMuxer->Execute();
+  upMuxer->ClearInputs();
+  return TASK_EXEC_SUCCESS == details.m_status;
+}
+
+bool PyMuxer::Flush(TaskExecDetails& details) {
+  details = upMuxer->Flush();
+  return TASK_EXEC_SUCCESS == details.m_status;
+}
+
+bool PyMuxer::IsAsync() const { return upMuxer->IsAsync(); }
+
+void Init_PyMuxer(py::module& m) {
+  py::class_<PyMuxer, shared_ptr<PyMuxer>>(
+      m, "PyMuxer", "Video muxer class. Writes compressed packets to file.")
+      .def(py::init<const string&, const StreamParams&,
+                    const map<string, string>&, const string&, bool>(),
+           py::arg("output"), py::arg("params"), py::arg("opts"),
+           py::arg("format") = "", py::arg("async_write") = false,
+           R"pbdoc(
+        Constructor method.
+        Opens the output and writes container header.
+
+        :param output: path to output file
+        :param params: video stream parameters, e. g. ones given by PyDemuxer
+        :param opts: AVDictionary options that will be passed to AVIO and AVFormat contexts.
+        :param format: container format name, e. g. mp4, matroska or mpegts. Guessed from output file extension if empty.
+        :param async_write: write packets in background thread
+    )pbdoc")
+      .def(
+          "MuxSinglePacket",
+          [](PyMuxer& self, py::array_t<uint8_t, py::array::c_style>& packet,
+             const PacketData& pkt_data) {
+            TaskExecDetails details;
+            auto const res = self.MuxSinglePacket(
+                packet.data(), packet.nbytes(), &pkt_data, details);
+            return std::make_tuple(res, details.m_info);
+          },
+          py::arg("packet"), py::arg("pkt_data"),
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Write single packet.
+        Packet is copied, so it may be reused right after the call. In async
+        mode write error is reported by one of the following calls.
+
+        :param packet: compressed packet
+        :param pkt_data: packet data. Timestamps are given in stream time base units.
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def(
+          "Flush",
+          [](PyMuxer& self) {
+            TaskExecDetails details;
+            auto const res = self.Flush(details);
+            return std::make_tuple(res, details.m_info);
+          },
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Write pending packets and container trailer.
+        Nothing can be written after that. It's also done upon destruction,
+        but errors are lost then.
+
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def_property_readonly("IsAsync", &PyMuxer::IsAsync,
+                             R"pbdoc(
+        Return True if packets are written in background thread.
+    )pbdoc");
+}
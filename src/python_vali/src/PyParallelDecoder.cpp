@@ -0,0 +1,365 @@
+/*
+ * Copyright 2024 Vision Labs LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VALI.hpp"
+
+#include <algorithm>
+
+using namespace std;
+using namespace VPF;
+
+namespace py = pybind11;
+
+constexpr auto TASK_EXEC_SUCCESS = TaskExecStatus::TASK_EXEC_SUCCESS;
+constexpr auto TASK_EXEC_FAIL = TaskExecStatus::TASK_EXEC_FAIL;
+
+PyParallelDecoder::PyParallelDecoder(const string& pathToFile,
+                                     const map<string, string>& ffmpeg_options,
+                                     size_t num_threads, size_t chunk_frames) {
+  if (!num_threads) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  chunk_frames = std::max(chunk_frames, (size_t)1U);
+
+  NvDecoderClInterface cli_iface(ffmpeg_options);
+  auto decoder = std::unique_ptr<DecodeFrame>(
+      DecodeFrame::Make(pathToFile.c_str(), cli_iface, std::nullopt));
+
+  auto details = decoder->BuildIndex();
+  if (TASK_EXEC_SUCCESS != details.m_status) {
+    throw std::runtime_error("Failed to build packet index: " + details.m_msg);
+  }
+  decoder->GetParams(m_params);
+
+  /* Chunk starts at key frame and spans whole GOPs until it has at least
+   * given number of frames.
+   */
+  auto index = decoder->GetIndex();
+  for (size_t i = 0U; i < index->Size(); i++) {
+    auto const& entry = index->At(i);
+    auto const is_gop_start = entry.key && entry.key_num == (int64_t)i;
+
+    if (m_chunks.empty() ||
+        (is_gop_start &&
+         m_chunks.back().num_frames >= (int64_t)chunk_frames)) {
+      m_chunks.push_back({(int64_t)i, 0});
+    }
+    m_chunks.back().num_frames++;
+  }
+
+  if (m_chunks.empty()) {
+    throw std::runtime_error("Input has no video frames");
+  }
+
+  m_queue_size = 0U;
+  for (auto& chunk : m_chunks) {
+    m_queue_size = std::max(m_queue_size, (size_t)chunk.num_frames);
+  }
+
+  // No point in having more decoders than chunks.
+  num_threads = std::min(num_threads, m_chunks.size());
+  for (size_t i = 0U; i < num_threads; i++) {
+    auto worker = std::make_unique<Worker>();
+    if (i) {
+      worker->decoder.reset(
+          DecodeFrame::Make(pathToFile.c_str(), cli_iface, std::nullopt));
+      worker->decoder->SetIndex(index);
+    } else {
+      worker->decoder = std::move(decoder);
+    }
+    m_workers.push_back(std::move(worker));
+  }
+
+  for (size_t i = 0U; i < m_workers.size(); i++) {
+    auto& worker = *m_workers[i].get();
+    worker.thread = std::thread(&PyParallelDecoder::Run, this,
+                                std::ref(worker), i);
+  }
+}
+
+PyParallelDecoder::~PyParallelDecoder() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+
+  for (auto& worker : m_workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+void PyParallelDecoder::Run(Worker& worker, size_t first_chunk) {
+  auto& decoder = *worker.decoder.get();
+  auto dst = std::shared_ptr<Buffer>(Buffer::Make(0U, nullptr));
+
+  for (auto c = first_chunk; c < m_chunks.size(); c += m_workers.size()) {
+    auto const& chunk = m_chunks[c];
+
+    for (int64_t i = 0; i < chunk.num_frames; i++) {
+      Slot slot;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock,
+                  [&] { return m_stop || worker.queue.size() < m_queue_size; });
+        if (m_stop) {
+          return;
+        }
+
+        if (!worker.free_frames.empty()) {
+          slot.frame = std::move(worker.free_frames.back());
+          worker.free_frames.pop_back();
+        }
+      }
+
+      // First frame of the chunk is decoded with seek to it.
+      SeekContext seek_ctx(chunk.start);
+      auto seek_ctx_buf = std::shared_ptr<Buffer>(
+          Buffer::Make(sizeof(seek_ctx), static_cast<void*>(&seek_ctx)));
+
+      /* Upon resolution change decoder returns no pixels but stashes the
+       * frame and returns it upon next call.
+       */
+      do {
+        slot.frame.resize(decoder.GetHostFrameSize());
+        dst->Update(slot.frame.size(), slot.frame.data());
+
+        decoder.ClearInputs();
+        decoder.SetInput(dst.get(), 0U);
+        if (!i && slot.details.m_info != TaskExecInfo::RES_CHANGE) {
+          decoder.SetInput(seek_ctx_buf.get(), 1U);
+        }
+
+        try {
+          slot.details = decoder.Execute();
+        } catch (std::exception& e) {
+          slot.details =
+              TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::FAIL, e.what());
+        }
+      } while (TASK_EXEC_SUCCESS == slot.details.m_status &&
+               TaskExecInfo::RES_CHANGE == slot.details.m_info);
+
+      slot.pkt_data = decoder.GetLastPacketData();
+
+      auto const failed = (TASK_EXEC_SUCCESS != slot.details.m_status);
+      slot.chunk_end = failed || (i + 1 == chunk.num_frames);
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        worker.queue.push_back(std::move(slot));
+      }
+      m_cv.notify_all();
+
+      // Consumer will never get past failed chunk.
+      if (failed) {
+        return;
+      }
+    }
+  }
+}
+
+size_t PyParallelDecoder::WaitFrame() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_cur_chunk >= m_chunks.size()) {
+    return 0U;
+  }
+
+  auto& worker = *m_workers[m_cur_chunk % m_workers.size()].get();
+  m_cv.wait(lock, [&] { return !worker.queue.empty(); });
+
+  auto const& slot = worker.queue.front();
+  return TASK_EXEC_SUCCESS == slot.details.m_status ? slot.frame.size() : 0U;
+}
+
+bool PyParallelDecoder::DecodeSingleFrame(uint8_t* dst, size_t dst_size,
+                                          TaskExecDetails& details,
+                                          PacketData& pkt_data) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_cur_chunk >= m_chunks.size()) {
+    details = TaskExecDetails(TASK_EXEC_FAIL, TaskExecInfo::END_OF_STREAM,
+                              "end of stream");
+    return false;
+  }
+
+  auto& worker = *m_workers[m_cur_chunk % m_workers.size()].get();
+  m_cv.wait(lock, [&] { return !worker.queue.empty(); });
+
+  /* Failed slot is the last one. Keep it in the queue so that every following
+   * call returns same details.
+   */
+  auto& slot = worker.queue.front();
+  details = slot.details;
+  pkt_data = slot.pkt_data;
+  if (TASK_EXEC_SUCCESS != slot.details.m_status) {
+    return false;
+  }
+
+  if (dst_size != slot.frame.size()) {
+    details = TaskExecDetails(TASK_EXEC_FAIL,
+                              TaskExecInfo::SRC_DST_SIZE_MISMATCH,
+                              "frame size mismatch");
+    return false;
+  }
+  memcpy(dst, slot.frame.data(), slot.frame.size());
+
+  if (slot.chunk_end) {
+    m_cur_chunk++;
+  }
+  worker.free_frames.push_back(std::move(slot.frame));
+  worker.queue.pop_front();
+
+  lock.unlock();
+  m_cv.notify_all();
+  return true;
+}
+
+uint32_t PyParallelDecoder::Width() const { return m_params.videoContext.width; }
+
+uint32_t PyParallelDecoder::Height() const {
+  return m_params.videoContext.height;
+}
+
+uint32_t PyParallelDecoder::NumFrames() const {
+  return m_params.videoContext.num_frames;
+}
+
+uint32_t PyParallelDecoder::HostFrameSize() const {
+  return m_params.videoContext.host_frame_size;
+}
+
+Pixel_Format PyParallelDecoder::PixelFormat() const {
+  return m_params.videoContext.format;
+}
+
+void Init_PyParallelDecoder(py::module& m) {
+  py::class_<PyParallelDecoder, shared_ptr<PyParallelDecoder>>(
+      m, "PyParallelDecoder",
+      "Video decoder which decodes single file with multiple threads.")
+      .def(py::init<const string&, const map<string, string>&, size_t,
+                    size_t>(),
+           py::arg("input"), py::arg("opts"), py::arg("num_threads") = 0U,
+           py::arg("chunk_frames") = 32U,
+           py::call_guard<py::gil_scoped_release>(),
+           R"pbdoc(
+        Constructor method.
+        Builds packet index and splits input into chunks at key frames.
+        Every chunk is decoded by one of independent decoders which run in
+        separate threads. Only decoding without HW acceleration is supported.
+        Every decoder keeps up to one chunk of decoded frames, so memory
+        consumption is proportional to num_threads * chunk_frames.
+
+        :param input: path to input file
+        :param opts: AVDictionary options that will be passed to AVFormat context.
+        :param num_threads: number of decoders. Pass 0 to use all CPU cores.
+        :param chunk_frames: minimal number of frames in chunk. Chunk consists of whole GOPs.
+    )pbdoc")
+      .def(
+          "DecodeSingleFrame",
+          [](PyParallelDecoder& self, py::array& frame, PacketData& pkt_data) {
+            // Array is resized with GIL held, waiting is done without it.
+            size_t frame_size = 0U;
+            {
+              py::gil_scoped_release gil_release;
+              frame_size = self.WaitFrame();
+            }
+
+            if (frame_size && frame_size != (size_t)frame.nbytes()) {
+              frame.resize({frame_size}, false);
+            }
+
+            auto p_frame = static_cast<uint8_t*>(frame.mutable_data());
+            auto const size = (size_t)frame.nbytes();
+
+            TaskExecDetails details;
+            auto success = false;
+            {
+              py::gil_scoped_release gil_release;
+              success = self.DecodeSingleFrame(p_frame, size, details,
+                                               pkt_data);
+            }
+
+            return std::make_tuple(success, details.m_info);
+          },
+          py::arg("frame"), py::arg("pkt_data"),
+          R"pbdoc(
+        Return next decoded video frame in presentation order.
+
+        :param frame: decoded video frame
+        :param pkt_data: decoded video frame packet data
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def(
+          "DecodeSingleFrame",
+          [](PyParallelDecoder& self, py::array& frame) {
+            size_t frame_size = 0U;
+            {
+              py::gil_scoped_release gil_release;
+              frame_size = self.WaitFrame();
+            }
+
+            if (frame_size && frame_size != (size_t)frame.nbytes()) {
+              frame.resize({frame_size}, false);
+            }
+
+            auto p_frame = static_cast<uint8_t*>(frame.mutable_data());
+            auto const size = (size_t)frame.nbytes();
+
+            TaskExecDetails details;
+            PacketData pkt_data;
+            auto success = false;
+            {
+              py::gil_scoped_release gil_release;
+              success = self.DecodeSingleFrame(p_frame, size, details,
+                                               pkt_data);
+            }
+
+            return std::make_tuple(success, details.m_info);
+          },
+          py::arg("frame"),
+          R"pbdoc(
+        Return next decoded video frame in presentation order.
+
+        :param frame: decoded video frame
+        :return: tuple, first element is True in case of success, False otherwise. Second elements is TaskExecInfo.
+    )pbdoc")
+      .def_property_readonly("Width", &PyParallelDecoder::Width,
+                             R"pbdoc(
+        Return encoded video file width in pixels.
+    )pbdoc")
+      .def_property_readonly("Height", &PyParallelDecoder::Height,
+                             R"pbdoc(
+        Return encoded video file height in pixels.
+    )pbdoc")
+      .def_property_readonly("NumFrames", &PyParallelDecoder::NumFrames,
+                             R"pbdoc(
+        Return number of video frames in encoded video file.
+    )pbdoc")
+      .def_property_readonly("HostFrameSize", &PyParallelDecoder::HostFrameSize,
+                             R"pbdoc(
+        Return amount of bytes needed to store decoded frame.
+    )pbdoc")
+      .def_property_readonly("Format", &PyParallelDecoder::PixelFormat,
+                             R"pbdoc(
+        Return encoded video file pixel format.
+    )pbdoc")
+      .def_property_readonly("NumThreads", &PyParallelDecoder::NumThreads,
+                             R"pbdoc(
+        Return number of decoders which run in parallel.
+    )pbdoc")
+      .def_property_readonly("NumChunks", &PyParallelDecoder::NumChunks,
+                             R"pbdoc(
+        Return number of chunks input is split into.
+    )pbdoc");
+}
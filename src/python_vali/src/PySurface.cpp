@@ -83,7 +83,7 @@ string ToString(Surface& self) {
   return ss.str();
 }
 
-static void dlpack_capsule_deleter(PyObject* self) {
+void dlpack_capsule_deleter(PyObject* self) {
   if (PyCapsule_IsValid(self, "used_dltensor")) {
     return;
   }
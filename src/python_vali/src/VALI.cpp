@@ -15,6 +15,7 @@
  */
 
 #include "VALI.hpp"
+#include "DecodeThreadBudget.hpp"
 #include "dlpack.h"
 
 using namespace std;
@@ -143,10 +144,20 @@ void Init_PySurfaceResizer(py::module&);
 
 void Init_PyDecoder(py::module&);
 
+void Init_PyParallelDecoder(py::module&);
+
+void Init_PyDemuxer(py::module&);
+
+void Init_PyMuxer(py::module&);
+
+void Init_PyClipCutter(py::module&);
+
 void Init_PyNvEncoder(py::module&);
 
 void Init_PySurface(py::module&);
 
+void Init_PyHostFrame(py::module&);
+
 void Init_PyFrameConverter(py::module&);
 
 void Init_PyNvJpegEncoder(py::module& m);
@@ -245,6 +256,24 @@ PYBIND11_MODULE(_python_vali, m) {
              "Input and output size mismatch")
       .export_values();
 
+  py::enum_<DecodeMode>(m, "DecodeMode")
+      .value("FULL", DecodeMode::FULL, "Decode every frame.")
+      .value("KEY_FRAMES", DecodeMode::KEY_FRAMES,
+             "Decode key frames only, drop other packets upon demuxing.")
+      .export_values();
+
+  py::enum_<ScalingAlgorithm>(m, "ScalingAlgorithm")
+      .value("FAST_BILINEAR", ScalingAlgorithm::FAST_BILINEAR,
+             "Fast bilinear, lower quality.")
+      .value("BILINEAR", ScalingAlgorithm::BILINEAR, "Bilinear.")
+      .value("BICUBIC", ScalingAlgorithm::BICUBIC, "Bicubic.")
+      .value("NEAREST", ScalingAlgorithm::NEAREST, "Nearest neighbor.")
+      .value("AREA", ScalingAlgorithm::AREA,
+             "Area averaging, good for downscaling.")
+      .value("LANCZOS", ScalingAlgorithm::LANCZOS, "Lanczos.")
+      .value("SPLINE", ScalingAlgorithm::SPLINE, "Natural bicubic spline.")
+      .export_values();
+
   py::enum_<ColorSpace>(m, "ColorSpace")
       .value("BT_601", ColorSpace::BT_601, "BT.601 color space.")
       .value("BT_709", ColorSpace::BT_709, "BT.709 color space.")
@@ -329,6 +358,107 @@ PYBIND11_MODULE(_python_vali, m) {
         return ss.str();
       });
 
+  py::class_<StageStats, shared_ptr<StageStats>>(
+      m, "StageStats", "Wall time spent in single decoding stage")
+      .def_readonly("count", &StageStats::count, "Number of calls.")
+      .def_property_readonly(
+          "total_time",
+          [](shared_ptr<StageStats> self) { return self->total_ns * 1e-9; },
+          "Cumulative wall time in seconds.")
+      .def_readonly("histogram", &StageStats::histogram,
+                    "Log2 histogram of call duration. Element N counts calls "
+                    "which took [2^N, 2^(N+1)) microseconds.")
+      .def("__repr__", [](shared_ptr<StageStats> self) {
+        stringstream ss;
+        ss << "count: " << self->count << ", ";
+        ss << "total_time: " << self->total_ns * 1e-9 << " s";
+        return ss.str();
+      });
+
+  py::class_<DecoderStats, shared_ptr<DecoderStats>>(m, "DecoderStats",
+                                                     "Decoder statistics")
+      .def_readonly("num_pkt_read", &DecoderStats::num_pkt_read,
+                    "Packets read from input, all streams included.")
+      .def_readonly("num_pkt_sent", &DecoderStats::num_pkt_sent,
+                    "Packets sent to decoder.")
+      .def_readonly("num_frm_recv", &DecoderStats::num_frm_recv,
+                    "Frames received from decoder.")
+      .def_readonly("num_codec_reopen", &DecoderStats::num_codec_reopen,
+                    "Number of times codec was reopened upon seek.")
+      .def_readonly("num_threads", &DecoderStats::num_threads,
+                    "Number of threads used by codec.")
+      .def_readonly("bytes_read", &DecoderStats::bytes_read,
+                    "Bytes read from input.")
+      .def_readonly("demux", &DecoderStats::demux, "Packets demuxing.")
+      .def_readonly("send", &DecoderStats::send,
+                    "Sending packets to decoder.")
+      .def_readonly("receive", &DecoderStats::receive,
+                    "Receiving frames from decoder.")
+      .def_readonly("copy", &DecoderStats::copy,
+                    "Copying decoded frames to output.")
+      .def_readonly("seek", &DecoderStats::seek,
+                    "Demuxer seek and decoder reset.")
+      .def("__repr__", [](shared_ptr<DecoderStats> self) {
+        stringstream ss;
+        ss << "num_pkt_read:     " << self->num_pkt_read << "\n";
+        ss << "num_pkt_sent:     " << self->num_pkt_sent << "\n";
+        ss << "num_frm_recv:     " << self->num_frm_recv << "\n";
+        ss << "num_codec_reopen: " << self->num_codec_reopen << "\n";
+        ss << "num_threads:      " << self->num_threads << "\n";
+        ss << "bytes_read:       " << self->bytes_read << "\n";
+        ss << "demux:            " << self->demux.total_ns * 1e-9 << " s\n";
+        ss << "send:             " << self->send.total_ns * 1e-9 << " s\n";
+        ss << "receive:          " << self->receive.total_ns * 1e-9 << " s\n";
+        ss << "copy:             " << self->copy.total_ns * 1e-9 << " s\n";
+        ss << "seek:             " << self->seek.total_ns * 1e-9 << " s\n";
+        return ss.str();
+      });
+
+  py::class_<VideoContext, shared_ptr<VideoContext>>(
+      m, "StreamInfo", "Video stream parameters snapshot")
+      .def_readonly("width", &VideoContext::width, "Width in pixels.")
+      .def_readonly("height", &VideoContext::height, "Height in pixels.")
+      .def_readonly("profile", &VideoContext::profile, "Codec profile.")
+      .def_readonly("level", &VideoContext::level, "Codec level.")
+      .def_readonly("delay", &VideoContext::delay, "Decoder delay in frames.")
+      .def_readonly("gop_size", &VideoContext::gop_size, "GOP size.")
+      .def_readonly("num_frames", &VideoContext::num_frames,
+                    "Number of frames, may be 0 if unknown.")
+      .def_readonly("is_vfr", &VideoContext::is_vfr,
+                    "1 if video has variable framerate, 0 otherwise.")
+      .def_readonly("num_streams", &VideoContext::num_streams,
+                    "Number of streams in the input.")
+      .def_readonly("stream_index", &VideoContext::stream_index,
+                    "Video stream index.")
+      .def_readonly("host_frame_size", &VideoContext::host_frame_size,
+                    "Size of decoded frame in host memory in bytes.")
+      .def_readonly("bit_rate", &VideoContext::bit_rate, "Bitrate.")
+      .def_readonly("frame_rate", &VideoContext::frame_rate, "Framerate.")
+      .def_readonly("avg_frame_rate", &VideoContext::avg_frame_rate,
+                    "Average framerate.")
+      .def_readonly("time_base", &VideoContext::time_base,
+                    "Time base in seconds.")
+      .def_readonly("start_time", &VideoContext::start_time,
+                    "Stream start time in seconds.")
+      .def_readonly("duration", &VideoContext::duration, "Duration in seconds.")
+      .def_readonly("format", &VideoContext::format,
+                    "Pixel format of decoded frames.")
+      .def_readonly("color_space", &VideoContext::color_space, "Color space.")
+      .def_readonly("color_range", &VideoContext::color_range, "Color range.")
+      .def_readonly("metadata", &VideoContext::metadata, "Input metadata.")
+      .def("__repr__", [](shared_ptr<VideoContext> self) {
+        stringstream ss;
+        ss << "width:           " << self->width << "\n";
+        ss << "height:          " << self->height << "\n";
+        ss << "format:          " << self->format << "\n";
+        ss << "host_frame_size: " << self->host_frame_size << "\n";
+        ss << "num_frames:      " << self->num_frames << "\n";
+        ss << "frame_rate:      " << self->frame_rate << "\n";
+        ss << "time_base:       " << self->time_base << "\n";
+        ss << "duration:        " << self->duration << "\n";
+        return ss.str();
+      });
+
   py::class_<CudaStreamEvent, shared_ptr<CudaStreamEvent>>(m, "CudaStreamEvent",
                                                            "CUDA stream event")
       .def("Wait", &CudaStreamEvent::Wait,
@@ -442,8 +572,41 @@ PYBIND11_MODULE(_python_vali, m) {
         Set FFMpeg log level.
     )pbdoc");
 
+  m.def(
+      "SetDecodeThreadBudget",
+      [](uint32_t num_cores) {
+        DecodeThreadBudget::Instance().SetNumCores(num_cores);
+      },
+      py::arg("num_cores"),
+      R"pbdoc(
+        Set number of CPU cores shared by all software decoders in the process.
+        Every decoder gets number of threads proportional to its frame size
+        relative to frame size of all active decoders, but no less than 1.
+        Number of threads is assigned when decoder is created and doesn't
+        change afterwards. Decoders with explicit positive "threads" option
+        aren't affected.
+
+        :param num_cores: number of cores, 0 disables the budget.
+    )pbdoc");
+
+  m.def(
+      "GetDecodeThreadBudget",
+      []() { return DecodeThreadBudget::Instance().GetNumCores(); },
+      R"pbdoc(
+        Get number of CPU cores shared by all software decoders in the process.
+        0 means budget is disabled.
+    )pbdoc");
+
+  Init_PyDemuxer(m);
+
+  Init_PyMuxer(m);
+
+  Init_PyClipCutter(m);
+
   Init_PyDecoder(m);
 
+  Init_PyParallelDecoder(m);
+
   Init_PyNvEncoder(m);
 
   Init_PyFrameUploader(m);
@@ -456,6 +619,8 @@ PYBIND11_MODULE(_python_vali, m) {
 
   Init_PySurface(m);
 
+  Init_PyHostFrame(m);
+
   Init_PyFrameConverter(m);
 
   Init_PyNvJpegEncoder(m);
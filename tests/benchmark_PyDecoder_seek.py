@@ -0,0 +1,90 @@
+#
+# Copyright 2024 Vision Labs LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Measures number of random seeks per second.
+
+Usage:
+    python benchmark_PyDecoder_seek.py -i data/test.mp4 -n 1000 -g -1
+"""
+
+import argparse
+import random
+import time
+
+import numpy as np
+import python_vali as vali
+
+
+def benchmark(input: str, num_seeks: int, gpu_id: int, use_index: bool,
+              seed: int) -> float:
+    pyDec = vali.PyDecoder(input, {}, gpu_id=gpu_id)
+    if use_index:
+        pyDec.BuildIndex()
+
+    # Seek by number isn't supported for VFR videos without index.
+    num_frames = pyDec.NumFrames
+    duration = num_frames / pyDec.Framerate
+    by_number = use_index or not pyDec.IsVFR
+
+    if gpu_id < 0:
+        frame = np.ndarray(dtype=np.uint8, shape=())
+    else:
+        frame = vali.Surface.Make(
+            pyDec.Format, pyDec.Width, pyDec.Height, gpu_id=gpu_id)
+
+    rng = random.Random(seed)
+    start = time.perf_counter()
+    for _ in range(num_seeks):
+        if by_number:
+            seek_ctx = vali.SeekContext(
+                seek_frame=rng.randint(0, num_frames - 1))
+        else:
+            seek_ctx = vali.SeekContext(seek_ts=rng.uniform(0., duration))
+
+        if gpu_id < 0:
+            success, info = pyDec.DecodeSingleFrame(frame, seek_ctx)
+        else:
+            success, info = pyDec.DecodeSingleSurface(frame, seek_ctx)
+
+        if not success:
+            raise RuntimeError("Seek failed: " + str(info))
+
+    return num_seeks / (time.perf_counter() - start)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Measure PyDecoder random seek performance.")
+    parser.add_argument("-i", "--input", type=str, default="data/test.mp4",
+                        help="input video file")
+    parser.add_argument("-n", "--num_seeks", type=int, default=1000,
+                        help="number of seeks")
+    parser.add_argument("-g", "--gpu_id", type=int, default=-1,
+                        help="GPU id, negative value for CPU decoder")
+    parser.add_argument("-s", "--seed", type=int, default=0,
+                        help="random seed")
+    args = parser.parse_args()
+
+    # Older revisions have no packet index, compare without it then.
+    index_modes = [False]
+    if hasattr(vali.PyDecoder, "BuildIndex"):
+        index_modes.append(True)
+
+    for use_index in index_modes:
+        seeks_per_sec = benchmark(args.input, args.num_seeks, args.gpu_id,
+                                  use_index, args.seed)
+        print(f"index: {use_index}, seeks per second: {seeks_per_sec:.1f}")
@@ -0,0 +1,102 @@
+#
+# Copyright 2024 Vision Labs LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Measures per-frame cost of PyFrameConverter in microseconds.
+
+Three cases are measured:
+    steady:    same colorspace conversion context for every frame.
+    switching: colorspace changes every frame.
+    new:       new converter is created for every frame, as it happens when
+               many short lived streams of same resolution are processed.
+
+Run it against revisions before and after a change to compare.
+
+Usage:
+    python benchmark_PyFrameConverter.py -i data/test.mp4 -n 1000
+"""
+
+import argparse
+import time
+
+import numpy as np
+import python_vali as vali
+
+
+def decode_frames(input: str, num_frames: int) -> tuple:
+    pyDec = vali.PyDecoder(input, {}, gpu_id=-1)
+    frames = []
+    frame = np.ndarray(dtype=np.uint8, shape=())
+    while len(frames) < num_frames:
+        success, info = pyDec.DecodeSingleFrame(frame)
+        if not success:
+            break
+        frames.append(np.copy(frame))
+
+    if not len(frames):
+        raise RuntimeError("No frames decoded")
+
+    return frames, pyDec.Width, pyDec.Height, pyDec.Format
+
+
+def benchmark(frames: list, width: int, height: int, format: vali.PixelFormat,
+              num_runs: int, case: str) -> float:
+    def make_converter():
+        return vali.PyFrameConverter(
+            width, height, format, vali.PixelFormat.RGB)
+
+    contexts = [
+        vali.ColorspaceConversionContext(
+            vali.ColorSpace.BT_709, vali.ColorRange.MPEG),
+        vali.ColorspaceConversionContext(
+            vali.ColorSpace.BT_601, vali.ColorRange.JPEG),
+    ]
+
+    ffCvt = make_converter()
+    dst = np.ndarray(dtype=np.uint8, shape=())
+
+    # Warm up, so that allocations aren't measured.
+    ffCvt.Run(frames[0], dst, contexts[0])
+
+    start = time.perf_counter()
+    for i in range(num_runs):
+        if case == "new":
+            ffCvt = make_converter()
+        cc_ctx = contexts[i % 2] if case == "switching" else contexts[0]
+
+        success, info = ffCvt.Run(frames[i % len(frames)], dst, cc_ctx)
+        if not success:
+            raise RuntimeError("Conversion failed: " + str(info))
+
+    return (time.perf_counter() - start) / num_runs * 1e6
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Measure PyFrameConverter per-frame cost.")
+    parser.add_argument("-i", "--input", type=str, default="data/test.mp4",
+                        help="input video file")
+    parser.add_argument("-n", "--num_runs", type=int, default=1000,
+                        help="number of conversions")
+    parser.add_argument("-f", "--num_frames", type=int, default=16,
+                        help="number of decoded frames to convert in loop")
+    args = parser.parse_args()
+
+    frames, width, height, format = decode_frames(args.input,
+                                                  args.num_frames)
+    for case in ["steady", "switching", "new"]:
+        usec = benchmark(frames, width, height, format, args.num_runs, case)
+        print(f"{case}: {usec:.1f} us per frame")
@@ -22,6 +22,9 @@ import json
 import test_common as tc
 import logging
 import random
+import tempfile
+import threading
+import time
 from parameterized import parameterized
 
 
@@ -161,6 +164,38 @@ class TestDecoder(unittest.TestCase):
         self.assertLessEqual(
             np.abs(self.gtInfo.timebase - pyDec.Timebase), epsilon)
 
+    @parameterized.expand(tc.getDevices())
+    def test_info(self, device_name: str, device_id: int):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=device_id)
+        info = pyDec.Info
+        self.assertEqual(info.width, pyDec.Width)
+        self.assertEqual(info.height, pyDec.Height)
+        self.assertEqual(info.format, pyDec.Format)
+        self.assertEqual(info.level, pyDec.Level)
+        self.assertEqual(info.profile, pyDec.Profile)
+        self.assertEqual(info.gop_size, pyDec.GopSize)
+        self.assertEqual(info.num_frames, pyDec.NumFrames)
+        self.assertEqual(info.stream_index, pyDec.StreamIndex)
+        self.assertEqual(info.host_frame_size, pyDec.HostFrameSize)
+        self.assertEqual(info.color_space, pyDec.ColorSpace)
+        self.assertEqual(info.color_range, pyDec.ColorRange)
+        self.assertEqual(info.frame_rate, pyDec.Framerate)
+        self.assertEqual(info.time_base, pyDec.Timebase)
+        self.assertEqual(info.metadata, pyDec.Metadata)
+
+        # Snapshot stays the same while decoding.
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        surf = vali.Surface.Make(pyDec.Format, pyDec.Width, pyDec.Height,
+                                 gpu_id=device_id) if device_id >= 0 else None
+        for i in range(0, self.gtInfo.gop_size):
+            if device_id >= 0:
+                success, details = pyDec.DecodeSingleSurface(surf)
+            else:
+                success, details = pyDec.DecodeSingleFrame(frame)
+            self.assertTrue(success, details)
+            self.assertEqual(pyDec.Info.width, info.width)
+            self.assertEqual(pyDec.Info.height, info.height)
+
     @parameterized.expand([
         ["from_url"],
         ["from_buf"]
@@ -242,16 +277,35 @@ class TestDecoder(unittest.TestCase):
 
     @parameterized.expand([
         ["from_url"],
-        ["from_buf"]
+        ["from_buf"],
+        ["from_buf_read_ahead"],
+        ["from_bytes"],
+        ["from_numpy"],
+        ["from_fd"]
     ])
     def test_check_all_frames_cpu(self, input_type):
         buf = None
+        fd = None
 
         if input_type == "from_url":
             pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
-        else:
+        elif input_type == "from_buf":
             buf = open(self.gtInfo.uri, "rb")
             pyDec = vali.PyDecoder(buf, {}, gpu_id=-1)
+        elif input_type == "from_buf_read_ahead":
+            # Ring is smaller than the input to make it wrap around.
+            buf = open(self.gtInfo.uri, "rb")
+            pyDec = vali.PyDecoder(buf, {}, gpu_id=-1, read_ahead=64 * 1024)
+        elif input_type == "from_bytes":
+            with open(self.gtInfo.uri, "rb") as f:
+                pyDec = vali.PyDecoder(f.read(), {}, gpu_id=-1)
+        elif input_type == "from_numpy":
+            # Decoder keeps the buffer alive.
+            pyDec = vali.PyDecoder(
+                np.fromfile(self.gtInfo.uri, dtype=np.uint8), {}, gpu_id=-1)
+        else:
+            fd = os.open(self.gtInfo.uri, os.O_RDONLY)
+            pyDec = vali.PyDecoder(fd=fd, opts={}, gpu_id=-1)
 
         dec_frames = 0
         with open(self.yuvInfo.uri, "rb") as f_in:
@@ -284,6 +338,284 @@ class TestDecoder(unittest.TestCase):
         if buf is not None:
             buf.close()
 
+        if fd is not None:
+            os.close(fd)
+
+    def test_prefetch_cpu(self):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        pyDecPrefetch = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        pyDecPrefetch.SetPrefetch(4)
+        self.assertEqual(pyDecPrefetch.Prefetch, 4)
+
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        frame_prefetch = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        pkt_data_prefetch = vali.PacketData()
+
+        dec_frames = 0
+        while True:
+            success, details = pyDec.DecodeSingleFrame(frame, pkt_data)
+            success_prefetch, details_prefetch = \
+                pyDecPrefetch.DecodeSingleFrame(
+                    frame_prefetch, pkt_data_prefetch)
+
+            self.assertEqual(success, success_prefetch)
+            self.assertEqual(details, details_prefetch)
+            if not success:
+                break
+
+            self.assertEqual(pkt_data.pts, pkt_data_prefetch.pts)
+            self.assertTrue(np.array_equal(frame, frame_prefetch))
+            dec_frames += 1
+
+        self.assertEqual(self.gtInfo.num_frames, dec_frames)
+        self.assertEqual(details_prefetch, vali.TaskExecInfo.END_OF_STREAM)
+
+        # Decoder shall keep returning EOS.
+        success, details = pyDecPrefetch.DecodeSingleFrame(frame_prefetch)
+        self.assertFalse(success)
+        self.assertEqual(details, vali.TaskExecInfo.END_OF_STREAM)
+
+    def test_prefetch_buffered_reader_cpu(self):
+        # Prefetch thread takes GIL to read from file object.
+        with open(self.gtInfo.uri, "rb") as buf:
+            pyDec = vali.PyDecoder(buf, {}, gpu_id=-1)
+            pyDec.SetPrefetch(4)
+
+            frame = np.ndarray(dtype=np.uint8, shape=())
+            for _ in range(self.gtInfo.num_frames // 2):
+                success, details = pyDec.DecodeSingleFrame(frame)
+                self.assertTrue(success, details)
+
+                # Properties don't wait for background decode.
+                self.assertEqual(pyDec.Width, self.gtInfo.width)
+                self.assertEqual(pyDec.Info.height, self.gtInfo.height)
+                self.assertFalse(pyDec.IsAccelerated)
+
+            # Decoder is destroyed while prefetch thread is running.
+            del pyDec
+
+    def test_stats_cpu(self):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        frame = np.ndarray(dtype=np.uint8, shape=())
+
+        dec_frames = 0
+        while pyDec.DecodeSingleFrame(frame)[0]:
+            dec_frames += 1
+
+        stats = pyDec.Stats()
+        self.assertEqual(dec_frames, stats.num_frm_recv)
+        self.assertEqual(dec_frames, stats.copy.count)
+        self.assertGreaterEqual(stats.num_pkt_read, stats.num_pkt_sent)
+        self.assertGreater(stats.bytes_read, 0)
+        self.assertEqual(stats.seek.count, 0)
+        self.assertEqual(stats.num_codec_reopen, 0)
+
+        for stage in [stats.demux, stats.send, stats.receive, stats.copy]:
+            self.assertGreater(stage.count, 0)
+            self.assertGreater(stage.total_time, 0.0)
+            self.assertEqual(sum(stage.histogram), stage.count)
+
+        # Seek far back from the end of stream.
+        seek_ctx = vali.SeekContext(seek_frame=self.gtInfo.gop_size)
+        success, details = pyDec.DecodeSingleFrame(frame, seek_ctx)
+        self.assertTrue(success, details)
+
+        stats = pyDec.Stats()
+        self.assertEqual(stats.seek.count, 1)
+        self.assertEqual(dec_frames + 1, stats.copy.count)
+
+    def test_thread_budget_cpu(self):
+        self.assertEqual(vali.GetDecodeThreadBudget(), 0)
+        num_cores = 4
+        vali.SetDecodeThreadBudget(num_cores)
+        try:
+            self.assertEqual(vali.GetDecodeThreadBudget(), num_cores)
+
+            # Every new decoder of same resolution gets smaller share.
+            decoders = [vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+                        for i in range(0, 3)]
+            threads = [pyDec.Stats().num_threads for pyDec in decoders]
+            for i in range(0, len(threads)):
+                self.assertGreaterEqual(threads[i], 1)
+                self.assertLessEqual(threads[i], num_cores)
+                if i > 0:
+                    self.assertLessEqual(threads[i], threads[i - 1])
+
+            # Only minimum of one thread per decoder exceeds the budget.
+            self.assertLessEqual(sum(threads),
+                                 num_cores + len(threads) - 1)
+
+            # Explicit number of threads isn't affected.
+            pyDec = vali.PyDecoder(self.gtInfo.uri, {"threads": "3"},
+                                   gpu_id=-1)
+            self.assertEqual(pyDec.Stats().num_threads, 3)
+            decoders.append(pyDec)
+
+            frame = np.ndarray(dtype=np.uint8, shape=())
+            for pyDec in decoders:
+                success, details = pyDec.DecodeSingleFrame(frame)
+                self.assertTrue(success, details)
+        finally:
+            vali.SetDecodeThreadBudget(0)
+
+    @unittest.skipUnless(hasattr(os, "mkfifo"), "named pipes not supported")
+    def test_live_mode_cpu(self):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            # Named pipe isn't seekable, MPEG-TS doesn't need seek.
+            ts_path = os.path.join(tmp_dir, "live.ts")
+            pyDmx = vali.PyDemuxer(self.gtInfo.uri, {})
+            pyMux = vali.PyMuxer(ts_path, pyDmx.StreamParams, {}, "mpegts")
+            pkt_data = vali.PacketData()
+            while True:
+                packet, _ = pyDmx.DemuxSinglePacket(pkt_data)
+                if packet is None:
+                    break
+                success, info = pyMux.MuxSinglePacket(packet, pkt_data)
+                self.assertTrue(success, info)
+            success, info = pyMux.Flush()
+            self.assertTrue(success, info)
+            del pyMux
+
+            # Stand-in for live source which writes faster than we consume.
+            fifo_path = os.path.join(tmp_dir, "live.fifo")
+            os.mkfifo(fifo_path)
+
+            def serve():
+                with open(ts_path, "rb") as src, open(fifo_path, "wb") as dst:
+                    dst.write(src.read())
+
+            server = threading.Thread(target=serve)
+            server.start()
+
+            pyDec = vali.PyDecoder(fifo_path, {}, gpu_id=-1)
+            pyDec.SetLiveMode(1)
+            self.assertTrue(pyDec.IsLive)
+            server.join()
+
+            # Give decoder time to get ahead of us.
+            time.sleep(1.0)
+
+            frame = np.ndarray(dtype=np.uint8, shape=())
+            num_popped = 0
+            last_pts = vali.NO_PTS
+            while True:
+                success, details = pyDec.DecodeSingleFrame(frame, pkt_data)
+                if not success:
+                    break
+                if details == vali.TaskExecInfo.SUCCESS:
+                    self.assertGreater(pkt_data.pts, last_pts)
+                    last_pts = pkt_data.pts
+                    num_popped += 1
+
+            self.assertEqual(details, vali.TaskExecInfo.END_OF_STREAM)
+            self.assertGreater(pyDec.NumDropped, 0)
+            self.assertLess(num_popped, self.gtInfo.num_frames)
+            self.assertEqual(num_popped + pyDec.NumDropped,
+                             self.gtInfo.num_frames)
+
+            # Prefetch disables live mode.
+            pyDec.SetPrefetch(1)
+            self.assertFalse(pyDec.IsLive)
+
+    def test_live_mode_after_decode_cpu(self):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        pyDec.SetPrefetch(2)
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        success, details = pyDec.DecodeSingleFrame(frame)
+        self.assertTrue(success, details)
+
+        # Codec can't be reopened in the middle of GOP.
+        with self.assertRaises(RuntimeError):
+            pyDec.SetLiveMode(1)
+        self.assertFalse(pyDec.IsLive)
+        self.assertEqual(pyDec.Prefetch, 2)
+
+        dec_frames = 1
+        while True:
+            success, details = pyDec.DecodeSingleFrame(frame)
+            if not success:
+                break
+            dec_frames += 1
+        self.assertEqual(details, vali.TaskExecInfo.END_OF_STREAM)
+        self.assertEqual(dec_frames, self.gtInfo.num_frames)
+
+    def test_decode_batch_cpu(self):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        pyDecBatch = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        frames = np.ndarray(dtype=np.uint8, shape=())
+        pkt_info = np.ndarray(dtype=np.int64, shape=())
+
+        batch_size = 10
+        dec_frames = 0
+        while True:
+            num_decoded, details = pyDecBatch.DecodeBatch(
+                batch_size, frames, pkt_info)
+            self.assertEqual(frames.shape,
+                             (batch_size, pyDecBatch.HostFrameSize))
+            self.assertEqual(pkt_info.shape, (batch_size, 3))
+
+            for i in range(0, num_decoded):
+                success, _ = pyDec.DecodeSingleFrame(frame, pkt_data)
+                self.assertTrue(success)
+                self.assertTrue(np.array_equal(frame, frames[i]))
+                self.assertEqual(pkt_data.pts, pkt_info[i][0])
+                self.assertEqual(pkt_data.dts, pkt_info[i][1])
+                self.assertEqual(pkt_data.key, pkt_info[i][2])
+
+            dec_frames += num_decoded
+            if num_decoded < batch_size:
+                break
+
+        self.assertEqual(self.gtInfo.num_frames, dec_frames)
+        self.assertEqual(details, vali.TaskExecInfo.END_OF_STREAM)
+
+    def test_host_frame_cpu(self):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        pyDecHost = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        host_frame = vali.HostFrame()
+        self.assertTrue(host_frame.Empty)
+
+        prev_planes = None
+        prev_frame = None
+        dec_frames = 0
+        while True:
+            success, _ = pyDec.DecodeSingleFrame(frame)
+            success_host, _ = pyDecHost.DecodeSingleFrame(host_frame)
+            self.assertEqual(success, success_host)
+            if not success:
+                break
+
+            self.assertEqual(host_frame.Format, vali.PixelFormat.YUV420)
+            self.assertEqual(host_frame.Width, self.gtInfo.width)
+            self.assertEqual(host_frame.Height, self.gtInfo.height)
+            self.assertEqual(host_frame.HostSize, frame.size)
+
+            # Buffer protocol and DLPack shall give same pixels.
+            planes = [np.asarray(p) for p in host_frame.Planes]
+            for plane, p in zip(planes, host_frame.Planes):
+                self.assertTrue(np.array_equal(plane, np.from_dlpack(p)))
+
+            self.assertTrue(np.array_equal(
+                frame, np.concatenate([p.flatten() for p in planes])))
+
+            # Planes of previous frame shall not be affected by decode.
+            if prev_planes is not None:
+                self.assertTrue(np.array_equal(
+                    prev_frame,
+                    np.concatenate([p.flatten() for p in prev_planes])))
+
+            prev_planes = planes
+            prev_frame = np.copy(frame)
+            dec_frames += 1
+
+        self.assertEqual(self.gtInfo.num_frames, dec_frames)
+
     @parameterized.expand([
         ["basic"],
         ["pts_increase_check"],
@@ -452,6 +784,280 @@ class TestDecoder(unittest.TestCase):
                 self.fail(
                     "Seek frame isnt same as continuous decode frame")
 
+    def test_seek_after_eos_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        frame_gt = np.ndarray(dtype=np.uint8, shape=())
+
+        success, _ = pyDec.DecodeSingleFrame(frame_gt)
+        self.assertTrue(success)
+
+        while True:
+            success, details = pyDec.DecodeSingleFrame(frame)
+            if not success:
+                break
+        self.assertEqual(details, vali.TaskExecInfo.END_OF_STREAM)
+
+        # Decoder shall be reset by seek, including end of decode state.
+        seek_ctx = vali.SeekContext(seek_frame=0)
+        success, _ = pyDec.DecodeSingleFrame(frame, seek_ctx)
+        self.assertTrue(success)
+        self.assertTrue(np.array_equal(frame, frame_gt))
+
+    def test_seek_forward_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frames_gt = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        while pyDec.DecodeSingleFrame(frame)[0]:
+            frames_gt.append(np.copy(frame))
+
+        # Monotonically increasing targets with small strides, some of them
+        # cross key frames.
+        targets = [0, 1, 3, 6, 10, 11, 12, 15, 23, 25, 40, 41, 95]
+        for use_index in [False, True]:
+            pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+            if use_index:
+                pyDec.BuildIndex()
+
+            for frame_num in targets:
+                seek_ctx = vali.SeekContext(seek_frame=frame_num)
+                success, _ = pyDec.DecodeSingleFrame(frame, seek_ctx)
+                self.assertTrue(success)
+                self.assertTrue(np.array_equal(frame, frames_gt[frame_num]))
+
+    def test_seek_pkt_data_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        pts_gt = []
+        while pyDec.DecodeSingleFrame(frame, pkt_data)[0]:
+            pts_gt.append(pkt_data.pts)
+
+        # Packet data shall belong to seek target, not to preceding frames
+        # which are decoded on the way to it.
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        for frame_num in [30, 7, 20, 21, 59]:
+            seek_ctx = vali.SeekContext(seek_frame=frame_num)
+            success, _ = pyDec.DecodeSingleFrame(frame, pkt_data, seek_ctx)
+            self.assertTrue(success)
+            self.assertEqual(pkt_data.pts, pts_gt[frame_num])
+
+    def test_decode_frames_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        frames_gt = []
+        pts_gt = []
+        while pyDec.DecodeSingleFrame(frame, pkt_data)[0]:
+            frames_gt.append(np.copy(frame))
+            pts_gt.append(pkt_data.pts)
+
+        frame_nums = [40, 3, 41, 90, 3, 0, 13]
+        frames = np.ndarray(dtype=np.uint8, shape=())
+        pkt_info = np.ndarray(dtype=np.int64, shape=())
+        for use_index in [False, True]:
+            pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+            if use_index:
+                pyDec.BuildIndex()
+
+            success, _ = pyDec.DecodeFrames(frame_nums, frames, pkt_info)
+            self.assertTrue(success)
+            self.assertEqual(frames.shape,
+                             (len(frame_nums), pyDec.HostFrameSize))
+
+            for i, frame_num in enumerate(frame_nums):
+                self.assertTrue(np.array_equal(frames[i], frames_gt[frame_num]))
+                self.assertEqual(pkt_info[i][0], pts_gt[frame_num])
+
+    def test_packet_index_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        # Decode all frames to compare against.
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frames_gt = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        while pyDec.DecodeSingleFrame(frame)[0]:
+            frames_gt.append(np.copy(frame))
+        self.assertEqual(gtInfo.num_frames, len(frames_gt))
+
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            index_path = os.path.join(tmp_dir, "test.idx")
+            pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+            pyDec.BuildIndex(index_path)
+            self.assertEqual(gtInfo.num_frames, pyDec.NumFrames)
+
+            # Decoder is rewound after index is built.
+            success, _ = pyDec.DecodeSingleFrame(frame)
+            self.assertTrue(success)
+            self.assertTrue(np.array_equal(frame, frames_gt[0]))
+
+            pyDecLoaded = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+            pyDecLoaded.LoadIndex(index_path)
+            self.assertEqual(gtInfo.num_frames, pyDecLoaded.NumFrames)
+
+            # Index seek shall give exact frame, backwards and forward.
+            for dec in [pyDec, pyDecLoaded]:
+                for frame_num in [50, 3, 95, 12, 11, 0, 60]:
+                    seek_ctx = vali.SeekContext(seek_frame=frame_num)
+                    success, _ = dec.DecodeSingleFrame(frame, seek_ctx)
+                    self.assertTrue(success)
+                    self.assertTrue(
+                        np.array_equal(frame, frames_gt[frame_num]))
+
+                seek_ctx = vali.SeekContext(seek_frame=gtInfo.num_frames)
+                success, details = dec.DecodeSingleFrame(frame, seek_ctx)
+                self.assertFalse(success)
+                self.assertEqual(details, vali.TaskExecInfo.END_OF_STREAM)
+
+    def test_parallel_decode_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frames_gt = []
+        pkts_gt = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        while pyDec.DecodeSingleFrame(frame, pkt_data)[0]:
+            frames_gt.append(np.copy(frame))
+            pkts_gt.append(pkt_data.pts)
+
+        # 96 frames with gop 12 give 8 chunks.
+        pyParDec = vali.PyParallelDecoder(
+            gtInfo.uri, {}, num_threads=3, chunk_frames=12)
+        self.assertEqual(3, pyParDec.NumThreads)
+        self.assertEqual(gtInfo.num_frames // gtInfo.gop_size,
+                         pyParDec.NumChunks)
+
+        # Frames shall come in the same order as from sequential decoder.
+        for i in range(0, len(frames_gt)):
+            success, info = pyParDec.DecodeSingleFrame(frame, pkt_data)
+            self.assertTrue(success, str(info))
+            self.assertTrue(np.array_equal(frame, frames_gt[i]))
+            self.assertEqual(pkt_data.pts, pkts_gt[i])
+
+        success, info = pyParDec.DecodeSingleFrame(frame)
+        self.assertFalse(success)
+        self.assertEqual(info, vali.TaskExecInfo.END_OF_STREAM)
+
+    def test_key_frames_mode_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frames_gt = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        while pyDec.DecodeSingleFrame(frame, pkt_data)[0]:
+            if pkt_data.key:
+                frames_gt.append(np.copy(frame))
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        pyDec.SetMode(vali.DecodeMode.KEY_FRAMES)
+        self.assertEqual(pyDec.Mode, vali.DecodeMode.KEY_FRAMES)
+
+        num_frames = 0
+        while True:
+            success, info = pyDec.DecodeSingleFrame(frame, pkt_data)
+            if not success:
+                self.assertEqual(info, vali.TaskExecInfo.END_OF_STREAM)
+                break
+            self.assertTrue(pkt_data.key)
+            self.assertTrue(np.array_equal(frame, frames_gt[num_frames]))
+            num_frames += 1
+
+        self.assertEqual(gtInfo.num_frames // gtInfo.gop_size, num_frames)
+
+    def test_decode_packet_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frames_gt = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        while pyDec.DecodeSingleFrame(frame)[0]:
+            frames_gt.append(np.copy(frame))
+
+        pyDmx = vali.PyDemuxer(gtInfo.uri, {})
+        dmx_params = pyDmx.StreamParams
+
+        # Parameters given by hand lack pixel format, decoder shall cope.
+        params = vali.StreamParams(
+            dmx_params.Codec, dmx_params.Width, dmx_params.Height,
+            dmx_params.Extradata)
+
+        for params in [dmx_params, params]:
+            pyDmx = vali.PyDemuxer(gtInfo.uri, {})
+            pyDec = vali.PyDecoder(params, {}, gpu_id=-1)
+            frames = []
+            pkt_data = vali.PacketData()
+
+            while True:
+                packet, _ = pyDmx.DemuxSinglePacket(pkt_data)
+                success, info = pyDec.DecodePacket(
+                    frame, packet, pkt_data.pts if packet is not None else None)
+                if success:
+                    frames.append(np.copy(frame))
+                elif packet is not None:
+                    self.assertEqual(info, vali.TaskExecInfo.MORE_DATA_NEEDED)
+                elif info == vali.TaskExecInfo.END_OF_STREAM:
+                    break
+
+            self.assertEqual(len(frames_gt), len(frames))
+            for i in range(0, len(frames)):
+                self.assertTrue(np.array_equal(frames[i], frames_gt[i]))
+
+    def test_decode_packet_delay_cpu(self):
+        with open("gt_files.json") as f:
+            gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+        pyDec = vali.PyDecoder(gtInfo.uri, {}, gpu_id=-1)
+        frames_gt = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        while pyDec.DecodeSingleFrame(frame)[0]:
+            frames_gt.append(np.copy(frame))
+
+        # Frame threading delays output by several packets in a row.
+        pyDmx = vali.PyDemuxer(gtInfo.uri, {})
+        pyDec = vali.PyDecoder(pyDmx.StreamParams, {"threads": "4"},
+                               gpu_id=-1)
+        frames = []
+        pkt_data = vali.PacketData()
+        num_more_data = 0
+        max_more_data = 0
+
+        while True:
+            packet, _ = pyDmx.DemuxSinglePacket(pkt_data)
+            success, info = pyDec.DecodePacket(
+                frame, packet, pkt_data.pts if packet is not None else None)
+            if success:
+                frames.append(np.copy(frame))
+                num_more_data = 0
+            elif packet is not None:
+                self.assertEqual(info, vali.TaskExecInfo.MORE_DATA_NEEDED)
+                num_more_data += 1
+                max_more_data = max(max_more_data, num_more_data)
+            elif info == vali.TaskExecInfo.END_OF_STREAM:
+                break
+
+        self.assertGreater(max_more_data, 1)
+        self.assertEqual(len(frames_gt), len(frames))
+        for i in range(0, len(frames)):
+            self.assertTrue(np.array_equal(frames[i], frames_gt[i]))
+
     @tc.repeat(3)
     def test_seek_backwards_gpu(self):
         """
@@ -0,0 +1,70 @@
+#
+# Copyright 2024 Vision Labs LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import python_vali as vali
+import numpy as np
+import unittest
+import json
+import test_common as tc
+
+
+class TestDemuxer(unittest.TestCase):
+    def __init__(self, methodName):
+        super().__init__(methodName=methodName)
+
+        with open("gt_files.json") as f:
+            self.gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+    def test_stream_params(self):
+        pyDmx = vali.PyDemuxer(self.gtInfo.uri, {})
+        params = pyDmx.StreamParams
+        self.assertEqual(params.Width, self.gtInfo.width)
+        self.assertEqual(params.Height, self.gtInfo.height)
+        self.assertGreater(params.Timebase, 0.)
+        self.assertGreater(len(params.Extradata), 0)
+
+    def test_demux_all_packets(self):
+        pyDec = vali.PyDecoder(self.gtInfo.uri, {}, gpu_id=-1)
+        dec_pts = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        pkt_data = vali.PacketData()
+        while pyDec.DecodeSingleFrame(frame, pkt_data)[0]:
+            dec_pts.append(pkt_data.pts)
+
+        pyDmx = vali.PyDemuxer(self.gtInfo.uri, {})
+        dmx_pts = []
+        num_key = 0
+        while True:
+            packet, info = pyDmx.DemuxSinglePacket(pkt_data)
+            if packet is None:
+                self.assertEqual(info, vali.TaskExecInfo.END_OF_STREAM)
+                break
+
+            # Packet shares memory with demuxer, it's not writable.
+            self.assertFalse(packet.flags.writeable)
+            self.assertEqual(packet.size, pkt_data.bsl)
+            dmx_pts.append(pkt_data.pts)
+            num_key += pkt_data.key
+
+        # Packets come in decode order, frames in presentation order.
+        self.assertEqual(self.gtInfo.num_frames, len(dmx_pts))
+        self.assertEqual(sorted(dmx_pts), dec_pts)
+        self.assertEqual(self.gtInfo.num_frames // self.gtInfo.gop_size,
+                         num_key)
+
+
+if __name__ == "__main__":
+    unittest.main()
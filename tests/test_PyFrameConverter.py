@@ -74,6 +74,222 @@ class TestFrameConverter(unittest.TestCase):
                     self.fail(
                         "PSNR score is below threshold: " + str(score))
 
+    def test_yuv420_rgb_resize(self):
+        with open("gt_files.json") as f:
+            gt_values = json.load(f)
+            yuvInfo = tc.GroundTruth(**gt_values["basic"])
+            rgbInfo = tc.GroundTruth(**gt_values["basic_rgb"])
+
+        pyDec = vali.PyDecoder(
+            input=yuvInfo.uri,
+            opts={},
+            gpu_id=-1)
+
+        # Half resolution, so that area averaging is a plain 2x2 box filter.
+        dst_width = pyDec.Width // 2
+        dst_height = pyDec.Height // 2
+        ffCvt = vali.PyFrameConverter(
+            pyDec.Width,
+            pyDec.Height,
+            dst_width,
+            dst_height,
+            pyDec.Format,
+            vali.PixelFormat.RGB,
+            vali.ScalingAlgorithm.AREA)
+
+        ccCtx = vali.ColorspaceConversionContext(
+            vali.ColorSpace.BT_709,
+            vali.ColorRange.MPEG)
+
+        yuv_frame = np.ndarray(shape=(), dtype=np.uint8)
+        rgb_frame = np.ndarray(shape=(), dtype=np.uint8)
+        frame_size = rgbInfo.width * rgbInfo.height * 3
+
+        with open(rgbInfo.uri, "rb") as f_in:
+            for i in range(0, rgbInfo.num_frames):
+                success, _ = pyDec.DecodeSingleFrame(yuv_frame)
+                if not success:
+                    self.fail("Fail to decode frame: " + str(_))
+
+                success, _ = ffCvt.Run(yuv_frame, rgb_frame, ccCtx)
+                if not success:
+                    self.fail("Fail to convert frame: " + str(_))
+                self.assertEqual(rgb_frame.size, dst_width * dst_height * 3)
+
+                # Downscale full size ethalon the same way.
+                rgb_ethalon = np.fromfile(f_in, np.uint8, frame_size)
+                rgb_ethalon = rgb_ethalon.reshape(
+                    dst_height, 2, dst_width, 2, 3).mean(axis=(1, 3))
+                rgb_ethalon = np.round(rgb_ethalon).astype(np.uint8)
+
+                # Chroma is resampled differently, so threshold is lower.
+                score = tc.measurePSNR(rgb_ethalon.flatten(), rgb_frame)
+                if score < 30.0:
+                    tc.dumpFrameToDisk(rgb_frame, "cc_resize", dst_width,
+                                       dst_height, "rgb")
+                    self.fail(
+                        "PSNR score is below threshold: " + str(score))
+
+    def test_threads(self):
+        with open("gt_files.json") as f:
+            gt_values = json.load(f)
+            yuvInfo = tc.GroundTruth(**gt_values["basic"])
+
+        pyDec = vali.PyDecoder(
+            input=yuvInfo.uri,
+            opts={},
+            gpu_id=-1)
+
+        ccCtx = vali.ColorspaceConversionContext(
+            vali.ColorSpace.BT_709,
+            vali.ColorRange.MPEG)
+
+        yuv_frame = np.ndarray(shape=(), dtype=np.uint8)
+        success, _ = pyDec.DecodeSingleFrame(yuv_frame)
+        if not success:
+            self.fail("Fail to decode frame: " + str(_))
+
+        # Same size and resized, sliced output must match single threaded one.
+        for dst_width, dst_height in [
+            (pyDec.Width, pyDec.Height),
+            (pyDec.Width // 2, pyDec.Height // 2),
+        ]:
+            frames = []
+            for threads in [1, 4]:
+                ffCvt = vali.PyFrameConverter(
+                    pyDec.Width,
+                    pyDec.Height,
+                    dst_width,
+                    dst_height,
+                    pyDec.Format,
+                    vali.PixelFormat.RGB,
+                    threads=threads)
+
+                rgb_frame = np.ndarray(shape=(), dtype=np.uint8)
+                success, _ = ffCvt.Run(yuv_frame, rgb_frame, ccCtx)
+                if not success:
+                    self.fail("Fail to convert frame: " + str(_))
+                self.assertEqual(rgb_frame.size, dst_width * dst_height * 3)
+                frames.append(rgb_frame)
+
+            score = tc.measurePSNR(frames[0], frames[1])
+            if score < 44.0:
+                tc.dumpFrameToDisk(frames[1], "cc_threads", dst_width,
+                                   dst_height, "rgb")
+                self.fail("PSNR score is below threshold: " + str(score))
+
+    def test_yuv_rgb_32f_planar(self):
+        with open("gt_files.json") as f:
+            gt_values = json.load(f)
+            yuvInfo = tc.GroundTruth(**gt_values["basic"])
+
+        pyDec = vali.PyDecoder(
+            input=yuvInfo.uri,
+            opts={},
+            gpu_id=-1)
+        width = pyDec.Width
+        height = pyDec.Height
+
+        ccCtx = vali.ColorspaceConversionContext(
+            vali.ColorSpace.BT_709,
+            vali.ColorRange.MPEG)
+
+        yuv_frame = np.ndarray(shape=(), dtype=np.uint8)
+        success, _ = pyDec.DecodeSingleFrame(yuv_frame)
+        if not success:
+            self.fail("Fail to decode frame: " + str(_))
+
+        def convert(src, src_fmt, dst_fmt, dtype, mean=None, std=None):
+            ffCvt = vali.PyFrameConverter(width, height, src_fmt, dst_fmt)
+            if mean is not None:
+                ffCvt.SetNormalization(mean, std)
+
+            dst = np.ndarray(shape=(), dtype=dtype)
+            success, _ = ffCvt.Run(src, dst, ccCtx)
+            if not success:
+                self.fail("Fail to convert frame: " + str(_))
+            return dst
+
+        # libswscale output is the reference.
+        rgb_frame = convert(yuv_frame, vali.PixelFormat.YUV420,
+                            vali.PixelFormat.RGB, np.uint8)
+        rgb_planar = convert(yuv_frame, vali.PixelFormat.YUV420,
+                             vali.PixelFormat.RGB_32F_PLANAR, np.float32)
+        self.assertEqual(rgb_planar.size, width * height * 3)
+
+        rgb_kernel = np.round(np.clip(rgb_planar, 0.0, 1.0) * 255.0)
+        rgb_kernel = rgb_kernel.astype(np.uint8).reshape(3, height, width)
+        rgb_kernel = rgb_kernel.transpose(1, 2, 0).flatten()
+        score = tc.measurePSNR(rgb_frame, rgb_kernel)
+        if score < psnr_threshold:
+            self.fail("PSNR score is below threshold: " + str(score))
+
+        # NV12 input differs from YUV420 by chroma layout only.
+        nv12_frame = convert(yuv_frame, vali.PixelFormat.YUV420,
+                             vali.PixelFormat.NV12, np.uint8)
+        nv12_planar = convert(nv12_frame, vali.PixelFormat.NV12,
+                              vali.PixelFormat.RGB_32F_PLANAR, np.float32)
+        self.assertTrue(np.array_equal(rgb_planar, nv12_planar))
+
+        # Normalization is applied per channel.
+        mean = [0.485, 0.456, 0.406]
+        std = [0.229, 0.224, 0.225]
+        norm_planar = convert(yuv_frame, vali.PixelFormat.YUV420,
+                              vali.PixelFormat.RGB_32F_PLANAR, np.float32,
+                              mean, std)
+        norm_ethalon = (rgb_planar.reshape(3, -1) -
+                        np.array(mean, dtype=np.float32)[:, None]) / \
+            np.array(std, dtype=np.float32)[:, None]
+        self.assertTrue(np.allclose(norm_planar.reshape(3, -1), norm_ethalon,
+                                    atol=1e-4))
+
+        # Normalization is only supported by fused kernel.
+        ffCvt = vali.PyFrameConverter(
+            width, height, vali.PixelFormat.YUV420, vali.PixelFormat.RGB)
+        with self.assertRaises(ValueError):
+            ffCvt.SetNormalization(mean, std)
+
+    def test_rgb_planar(self):
+        with open("gt_files.json") as f:
+            gt_values = json.load(f)
+            rgbInfo = tc.GroundTruth(**gt_values["basic_rgb"])
+
+        width = rgbInfo.width
+        height = rgbInfo.height
+        frame_size = width * height * 3
+
+        ccCtx = vali.ColorspaceConversionContext(
+            vali.ColorSpace.BT_709,
+            vali.ColorRange.MPEG)
+
+        def convert(src, src_fmt, dst_fmt, dtype):
+            ffCvt = vali.PyFrameConverter(width, height, src_fmt, dst_fmt)
+            dst = np.ndarray(shape=(), dtype=dtype)
+            success, _ = ffCvt.Run(src, dst, ccCtx)
+            if not success:
+                self.fail("Fail to convert frame: " + str(_))
+            return dst
+
+        with open(rgbInfo.uri, "rb") as f_in:
+            rgb_frame = np.fromfile(f_in, np.uint8, frame_size)
+
+        # Planes go in R, G, B order, same as on GPU.
+        rgb_ethalon = rgb_frame.reshape(height, width, 3).transpose(2, 0, 1)
+
+        rgb_planar = convert(rgb_frame, vali.PixelFormat.RGB,
+                             vali.PixelFormat.RGB_PLANAR, np.uint8)
+        self.assertTrue(np.array_equal(rgb_planar, rgb_ethalon.flatten()))
+
+        rgb_packed = convert(rgb_planar, vali.PixelFormat.RGB_PLANAR,
+                             vali.PixelFormat.RGB, np.uint8)
+        self.assertTrue(np.array_equal(rgb_packed, rgb_frame))
+
+        rgb_32f_planar = convert(rgb_frame, vali.PixelFormat.RGB,
+                                 vali.PixelFormat.RGB_32F_PLANAR, np.float32)
+        self.assertTrue(np.allclose(rgb_32f_planar,
+                                    rgb_ethalon.flatten() / 255.0,
+                                    atol=1.0 / 255.0))
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,152 @@
+#
+# Copyright 2024 Vision Labs LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import os
+import python_vali as vali
+import numpy as np
+import unittest
+import json
+import tempfile
+import test_common as tc
+from parameterized import parameterized
+
+
+class TestMuxer(unittest.TestCase):
+    def __init__(self, methodName):
+        super().__init__(methodName=methodName)
+
+        with open("gt_files.json") as f:
+            self.gtInfo = tc.GroundTruth(**json.load(f)["basic"])
+
+    def decode_all(self, uri: str) -> list:
+        pyDec = vali.PyDecoder(uri, {}, gpu_id=-1)
+        frames = []
+        frame = np.ndarray(dtype=np.uint8, shape=())
+        while pyDec.DecodeSingleFrame(frame)[0]:
+            frames.append(np.copy(frame))
+        return frames
+
+    @parameterized.expand([
+        ["mp4", "mp4", False],
+        ["mkv", "matroska", True],
+        ["ts", "mpegts", True],
+    ])
+    def test_remux(self, ext: str, format: str, async_write: bool):
+        frames_gt = self.decode_all(self.gtInfo.uri)
+        self.assertEqual(self.gtInfo.num_frames, len(frames_gt))
+
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            output = os.path.join(tmp_dir, "remux." + ext)
+
+            pyDmx = vali.PyDemuxer(self.gtInfo.uri, {})
+            pyMux = vali.PyMuxer(output, pyDmx.StreamParams, {}, format,
+                                 async_write)
+            self.assertEqual(pyMux.IsAsync, async_write)
+
+            pkt_data = vali.PacketData()
+            last_packet = None
+            while True:
+                packet, _ = pyDmx.DemuxSinglePacket(pkt_data)
+                if packet is None:
+                    break
+
+                success, info = pyMux.MuxSinglePacket(packet, pkt_data)
+                self.assertTrue(success, info)
+                last_packet = packet
+
+            success, info = pyMux.Flush()
+            self.assertTrue(success, info)
+
+            # Nothing can be written after trailer.
+            success, _ = pyMux.MuxSinglePacket(last_packet, pkt_data)
+            self.assertFalse(success)
+
+            # Stream copy shall give bit exact frames.
+            frames = self.decode_all(output)
+            self.assertEqual(len(frames_gt), len(frames))
+            for i in range(0, len(frames)):
+                self.assertTrue(np.array_equal(frames[i], frames_gt[i]))
+
+    def test_cut_clips(self):
+        frames_gt = self.decode_all(self.gtInfo.uri)
+
+        pyDmx = vali.PyDemuxer(self.gtInfo.uri, {})
+        time_base = pyDmx.StreamParams.Timebase
+        pkt_data = vali.PacketData()
+        pts = []
+        while True:
+            packet, _ = pyDmx.DemuxSinglePacket(pkt_data)
+            if packet is None:
+                break
+            pts.append(pkt_data.pts)
+        pts.sort()
+
+        # Range is counted from stream start time.
+        def frame_ts(frame_num: int) -> float:
+            return (pts[frame_num] - pts[0]) * time_base
+
+        gop = self.gtInfo.gop_size
+        pyCut = vali.PyClipCutter(self.gtInfo.uri, {})
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            outputs = [os.path.join(tmp_dir, f"clip_{i}.mp4")
+                       for i in range(0, 4)]
+            ranges = [
+                # Both snapped to key frame at the beginning of 2nd GOP.
+                (frame_ts(gop + 2), frame_ts(2 * gop + 6)),
+                (frame_ts(gop), frame_ts(2 * gop + 6)),
+                # Last GOP, clip end is past the end of stream.
+                (frame_ts(self.gtInfo.num_frames - 2), 1e6),
+            ]
+
+            results = pyCut.Cut(ranges, outputs[:3])
+            for success, info in results:
+                self.assertTrue(success, info)
+
+            for i in range(0, 2):
+                frames = self.decode_all(outputs[i])
+                self.assertGreaterEqual(len(frames), gop + 6)
+                for j in range(0, len(frames)):
+                    self.assertTrue(np.array_equal(frames[j],
+                                                   frames_gt[gop + j]))
+
+            frames = self.decode_all(outputs[2])
+            self.assertEqual(len(frames), gop)
+
+            # Snap forward to key frame at the beginning of 3rd GOP.
+            results = pyCut.Cut(
+                [(frame_ts(gop + 2), frame_ts(3 * gop + 6))], [outputs[3]],
+                snap_backward=False)
+            self.assertTrue(results[0][0], results[0][1])
+            frames = self.decode_all(outputs[3])
+            self.assertTrue(np.array_equal(frames[0], frames_gt[2 * gop]))
+
+            # No key frame within the range.
+            last_range = (frame_ts(self.gtInfo.num_frames - gop + 1),
+                          frame_ts(self.gtInfo.num_frames - 1))
+            results = pyCut.Cut([last_range], [outputs[3]], snap_backward=False)
+            self.assertFalse(results[0][0])
+            self.assertEqual(results[0][1], vali.TaskExecInfo.INVALID_INPUT)
+
+            # Unwritable output only fails its own clip.
+            missing = os.path.join(tmp_dir, "missing", "clip.mp4")
+            results = pyCut.Cut([ranges[0], ranges[0]], [missing, outputs[0]])
+            self.assertFalse(results[0][0])
+            self.assertEqual(results[0][1], vali.TaskExecInfo.FAIL)
+            self.assertTrue(results[1][0], results[1][1])
+
+
+if __name__ == "__main__":
+    unittest.main()